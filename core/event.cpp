@@ -1,5 +1,50 @@
 #include "event.hpp"
 
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+namespace { // anonymous
+
+	// events taken from the window but not yet returned, by event_queue::wait()
+	// or coalescing, which outlive the iterator
+	std::deque<sf::Event> held;
+
+	// finds if the later event replaces the earlier, counting it if so
+	bool replaces(const sf::Event& earlier, const sf::Event& later)
+	{
+		if(earlier.type != later.type) {
+			return false;
+		}
+
+		switch(later.type) {
+		case sf::Event::MouseMoved:
+			++event_queue::stats.mouse_moved;
+			return true;
+		case sf::Event::Resized:
+			++event_queue::stats.resized;
+			return true;
+		case sf::Event::JoystickMoved:
+			if(earlier.joystickMove.joystickId != later.joystickMove.joystickId
+			   || earlier.joystickMove.axis != later.joystickMove.axis) {
+				return false;
+			}
+			++event_queue::stats.joystick_moved;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	bool coalescible(const sf::Event& event)
+	{
+		return event.type == sf::Event::MouseMoved
+			|| event.type == sf::Event::Resized
+			|| event.type == sf::Event::JoystickMoved;
+	}
+
+} // namespace anonymous
+
 // class event_iterator {{{
 
 event_iterator::event_iterator()
@@ -13,6 +58,20 @@ event_iterator::event_iterator(stdwindow& init)
 	++*this; // get first element
 }
 
+bool event_iterator::poll(sf::Event& out)
+{
+	if(!held.empty()) {
+		out = held.front();
+		held.pop_front();
+		return true;
+	}
+	if(!owner->window().pollEvent(out)) {
+		return false;
+	}
+	++event_queue::stats.polled;
+	return true;
+}
+
 event_iterator::value_type event_iterator::operator*() const
 {
 	return event;
@@ -20,9 +79,24 @@ event_iterator::value_type event_iterator::operator*() const
 
 event_iterator& event_iterator::operator++()
 {
-	if(!owner->window().pollEvent(event)) {
+	if(!this->poll(event)) {
 		owner = nullptr;
+		return *this;
+	}
+
+	if(event_queue::coalesce && coalescible(event)) {
+		// keep the latest of a run, and hold the event ending it
+		sf::Event next;
+		while(this->poll(next)) {
+			if(!replaces(event, next)) {
+				held.push_front(next);
+				break;
+			}
+			event = next;
+		}
 	}
+
+	++event_queue::stats.delivered;
 	return *this;
 }
 
@@ -47,6 +121,9 @@ bool event_iterator::operator!=(const event_iterator& other) const
 
 // class event_queue {{{
 
+bool event_queue::coalesce = false;
+event_queue::stats_type event_queue::stats{};
+
 event_queue::event_queue(stdwindow& init)
 	: owner(&init)
 {
@@ -62,4 +139,38 @@ event_iterator event_queue::end()
 	return {};
 }
 
+bool event_queue::wait(stdwindow& window)
+{
+	if(!held.empty()) {
+		return true;
+	}
+
+	sf::Event event;
+	if(!window.window().waitEvent(event)) {
+		return false;
+	}
+	++stats.polled;
+	held.push_back(event);
+	return true;
+}
+
+bool event_queue::wait(stdwindow& window, std::chrono::steady_clock::time_point deadline,
+                       std::chrono::steady_clock::duration interval)
+{
+	if(!held.empty()) {
+		return true;
+	}
+
+	sf::Event event;
+	for(auto now = std::chrono::steady_clock::now(); now <= deadline; now = std::chrono::steady_clock::now()) {
+		if(window.window().pollEvent(event)) {
+			++stats.polled;
+			held.push_back(event);
+			return true;
+		}
+		std::this_thread::sleep_for(std::min(deadline - now, interval));
+	}
+	return false;
+}
+
 // }}}
@@ -1,6 +1,9 @@
 /* -*- cpp.doxygen -*- */
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+
 #include <sfml/window/event.hpp>
 #include "disp/window.hpp"
 
@@ -11,6 +14,15 @@
  * This file provides the event_queue and event_iterator classes, which provide
  * a simpler interface for the event loop. Additionally, it allows the use of
  * range-for loops to loop over pending events.
+ *
+ * Optionally, runs of events which only update a position or size can be
+ * coalesced, see event_queue::coalesce.
+ *
+ * Events can also be waited for with event_queue::wait(). The event is then
+ * held, and returned first by the next iteration, so every event goes
+ * through the same path. Likewise the event ending a coalesced run is held
+ * until it is returned, so it is not lost if the loop is left early (e.g.
+ * by rt::skipframe()).
  */
 
 /**
@@ -30,6 +42,10 @@ private: // variables
 	stdwindow* owner;
 	sf::Event event;
 
+private: // internal methods
+
+	bool poll(sf::Event& out);
+
 public: // methods
 
 	event_iterator();
@@ -55,6 +71,42 @@ public: // methods
  */
 class event_queue
 {
+public: // statics
+
+	/// Counts of events polled, and those dropped by coalescing
+	struct stats_type
+	{
+		uint64_t polled;
+		uint64_t delivered;
+		uint64_t mouse_moved;
+		uint64_t resized;
+		uint64_t joystick_moved;
+	};
+
+	/**
+	 * Collapse consecutive MouseMoved, Resized and JoystickMoved events
+	 * (of the same joystick and axis) into the latest. This keeps their
+	 * order relative to other events, e.g. a move before a click is still
+	 * seen before it.
+	 */
+	static bool coalesce;
+
+	/// Totals since the program started
+	static stats_type stats;
+
+	/// Block until the window has an event. Returns false on an error
+	static bool wait(stdwindow& window);
+
+	/**
+	 * \fn wait
+	 * \brief Wait for an event until \p deadline
+	 *
+	 * SFML cannot wait with a timeout, so this polls every \p interval.
+	 * Returns false if there was no event before the deadline.
+	 */
+	static bool wait(stdwindow& window, std::chrono::steady_clock::time_point deadline,
+	                 std::chrono::steady_clock::duration interval);
+
 private: // variables
 
 	stdwindow* owner;
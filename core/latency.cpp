@@ -0,0 +1,187 @@
+#include "latency.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "include/fmt.hpp"
+
+namespace { // anonymous
+
+	using rt::clock;
+
+	rt::latency::histogram latency_histogram;
+	rt::latency::histogram phase_histograms[rt::latency::phase_count];
+
+	uint64_t events = 0;
+	rt::latency::cause pending_cause{0, {}};
+	bool has_cause = false;
+	clock::duration display_time{};
+
+	const char* phase_names[rt::latency::phase_count] = {
+		"poll",
+		"exec_step",
+		"on_frame",
+		"display",
+	};
+
+	// window and focus changes are not input
+	bool is_input(sf::Event::EventType type)
+	{
+		switch(type) {
+		case sf::Event::Closed:
+		case sf::Event::Resized:
+		case sf::Event::LostFocus:
+		case sf::Event::GainedFocus:
+		case sf::Event::MouseEntered:
+		case sf::Event::MouseLeft:
+		case sf::Event::JoystickConnected:
+		case sf::Event::JoystickDisconnected:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	double to_ms(clock::duration time)
+	{
+		return std::chrono::duration<double, std::milli>(time).count();
+	}
+
+} // namespace anonymous
+
+namespace rt {
+
+	namespace latency {
+
+		// class histogram {{{
+
+		histogram::histogram()
+			: buckets(), count(0), total(clock::duration::zero()), max(clock::duration::zero())
+		{
+		}
+
+		void histogram::add(clock::duration time)
+		{
+			auto us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+			int bucket = 0;
+			while(us > 0 && bucket < bucket_count - 1) {
+				us >>= 1;
+				++bucket;
+			}
+			++buckets[bucket];
+			++count;
+			total += time;
+			max = std::max(max, time);
+		}
+
+		uint64_t histogram::get_count() const
+		{
+			return count;
+		}
+
+		clock::duration histogram::mean() const
+		{
+			return count ? total / int64_t(count) : clock::duration::zero();
+		}
+
+		clock::duration histogram::get_max() const
+		{
+			return max;
+		}
+
+		clock::duration histogram::percentile(double fraction) const
+		{
+			uint64_t target = uint64_t(fraction * count);
+			uint64_t seen = 0;
+			for(int i = 0; i < bucket_count; ++i) {
+				seen += buckets[i];
+				if(seen > target || seen == count) {
+					return std::min<clock::duration>(std::chrono::microseconds(uint64_t(1) << i), max);
+				}
+			}
+			return max;
+		}
+
+		void histogram::print(std::ostream& os, const char* name) const
+		{
+			if(count == 0) {
+				fmt::print(os, "{:<10} no samples\n", name);
+				return;
+			}
+			fmt::print(os, "{:<10} {} samples, mean {:.2f} ms, p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms\n",
+			           name, count, to_ms(this->mean()), to_ms(this->percentile(0.5)),
+			           to_ms(this->percentile(0.9)), to_ms(this->percentile(0.99)), to_ms(max));
+
+			uint64_t largest = *std::max_element(buckets, buckets + bucket_count);
+			for(int i = 0; i < bucket_count; ++i) {
+				if(buckets[i] == 0) {
+					continue;
+				}
+				std::string bar(size_t(40 * buckets[i] / largest), '#');
+				fmt::print(os, "    < {:>9} us {:>8} {}\n", uint64_t(1) << i, buckets[i], bar);
+			}
+		}
+
+		// }}}
+
+		void event_polled(const sf::Event& event, clock::time_point when)
+		{
+			++events;
+			if(!has_cause && is_input(event.type)) {
+				pending_cause = cause{events, when};
+				has_cause = true;
+			}
+		}
+
+		const cause* current_cause()
+		{
+			return has_cause ? &pending_cause : nullptr;
+		}
+
+		void phase_done(phase_type phase, clock::duration time)
+		{
+			phase_histograms[phase].add(time);
+		}
+
+		void presented(clock::time_point start, clock::time_point end)
+		{
+			phase_histograms[phase_display].add(end - start);
+			display_time += end - start;
+
+			// the frame is visible once display() returns
+			if(has_cause) {
+				latency_histogram.add(end - pending_cause.time);
+				has_cause = false;
+			}
+		}
+
+		clock::duration take_display_time()
+		{
+			auto time = display_time;
+			display_time = clock::duration::zero();
+			return time;
+		}
+
+		const histogram& input_latency()
+		{
+			return latency_histogram;
+		}
+
+		const histogram& phase(phase_type type)
+		{
+			return phase_histograms[type];
+		}
+
+		void report(std::ostream& os)
+		{
+			fmt::print(os, "input to present latency:\n");
+			latency_histogram.print(os, "latency");
+			fmt::print(os, "frame phases:\n");
+			for(int i = 0; i < phase_count; ++i) {
+				phase_histograms[i].print(os, phase_names[i]);
+			}
+		}
+
+	} // namespace latency
+
+} // namespace rt
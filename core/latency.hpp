@@ -0,0 +1,125 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include <sfml/window/event.hpp>
+
+#include "core/time.hpp"
+
+/**
+ * \file
+ * \brief Input latency and frame timing
+ *
+ * This measures the time from an input event being polled to the first
+ * frame after it being presented, along with how long each part of the frame
+ * loop takes. The runtime does this when given the --latency option, and
+ * prints a report on exit.
+ *
+ * For the latency to be measured, frames must be shown with
+ * stdwindow::display() (i.e. `stdwin.display()`), not through the
+ * underlying window.
+ */
+
+namespace rt {
+
+	/**
+	 * \namespace rt::latency
+	 * \brief Input latency measurement
+	 */
+	namespace latency {
+
+		enum phase_type
+		{
+			phase_poll, ///< polling and handling events
+			phase_exec, ///< exec_step()
+			phase_frame, ///< on_frame, excluding display()
+			phase_display, ///< display(), including the frame limit
+			phase_count
+		};
+
+		/**
+		 * \class histogram
+		 * \brief Histogram of durations, in power of two microseconds
+		 *
+		 * Bucket 0 counts durations under 1us, and bucket n those from
+		 * 2^(n-1) up to 2^n us.
+		 */
+		class histogram
+		{
+		public: // statics
+
+			static constexpr int bucket_count = 32;
+
+		private: // variables
+
+			uint64_t buckets[bucket_count];
+			uint64_t count;
+			clock::duration total;
+			clock::duration max;
+
+		public: // methods
+
+			histogram();
+
+			void add(clock::duration time);
+
+			uint64_t get_count() const;
+			clock::duration mean() const;
+			clock::duration get_max() const;
+
+			/// Upper bound of the bucket holding the \p fraction (0 to 1) percentile
+			clock::duration percentile(double fraction) const;
+
+			/// Print the count, mean, percentiles and the buckets used
+			void print(std::ostream& os, const char* name) const;
+
+		};
+
+		/**
+		 * \struct cause
+		 * \brief Event a frame is responding to
+		 */
+		struct cause
+		{
+			uint64_t event; ///< number of the event, counting from 1
+			clock::time_point time; ///< when it was polled
+		};
+
+		/**
+		 * \fn event_polled
+		 * \brief Timestamp an event
+		 *
+		 * Input events mark the next presented frame as caused by
+		 * them, unless an earlier event has already marked it.
+		 */
+		void event_polled(const sf::Event& event, clock::time_point when);
+
+		/// Event the next presented frame will be caused by, or nullptr
+		const cause* current_cause();
+
+		/// Record the time a phase of the frame took
+		void phase_done(phase_type phase, clock::duration time);
+
+		/**
+		 * \fn presented
+		 * \brief Record a frame being shown
+		 *
+		 * This records the display phase, and the latency of the
+		 * frame's cause if it has one. Connect to stdwindow::on_display.
+		 */
+		void presented(clock::time_point start, clock::time_point end);
+
+		/// Total display() time since the last call, to separate it from on_frame
+		clock::duration take_display_time();
+
+		const histogram& input_latency();
+		const histogram& phase(phase_type type);
+
+		/// Print all histograms
+		void report(std::ostream& os);
+
+	} // namespace latency
+
+} // namespace rt
@@ -17,6 +17,11 @@ namespace rt {
 		stx::optional<int> wfps = 30;
 		int wstyle = sf::Style::Titlebar | sf::Style::Close;
 		vec2i wsize{1024, 600};
+		bool on_demand = false;
+		bool latency = false;
+		bool coalesce = false;
+		stx::optional<int> input_rate;
+		stx::optional<int> headless;
 
 		namespace { // anonymous
 
@@ -32,6 +37,18 @@ Usage: {0} [options...]
                         (titlebar), 'c' (close), 'r' (resize), and
                         'f' (fullscreen, not permitted with others).
     -s, --size=X,Y      Set the width (X) and height (Y) of the window.
+    -d, --on-demand     Only draw frames on input, timers, or when the
+                        program asks, instead of continuously.
+    -l, --latency       Measure input latency and frame timing, and
+                        print them on exit.
+    -e, --coalesce      Only handle the latest of consecutive mouse
+                        moves, resizes or joystick moves.
+    -i, --input-rate=HZ Sample the keys the program uses HZ times a
+                        second on a separate thread, for programs
+                        which apply input at the time it happened.
+    -H, --headless=N    Draw N frames into memory, without a window or
+                        GPU, then exit. Only for programs which draw
+                        through stdwindow::render().
     -h, --help          Display this message and exit.
 
 The program defied option are parsed, but their behaviour depends on the
@@ -117,10 +134,16 @@ program using this runtime, or may be ignored.
 				{"fps",   optional_argument, 0, 'f'},
 				{"style", optional_argument, 0, 'w'},
 				{"size",  required_argument, 0, 's'},
+				{"on-demand", no_argument,   0, 'd'},
+				{"latency", no_argument,     0, 'l'},
+				{"coalesce", no_argument,    0, 'e'},
+				{"input-rate", required_argument, 0, 'i'},
+				{"headless", required_argument, 0, 'H'},
 				{"help",  no_argument,       0, 'h'},
+				{0, 0, 0, 0},
 			};
 
-			const char* short_opts = "hf::w::s:a::b::c::";
+			const char* short_opts = "hf::w::s:dlei:H:a::b::c::";
 
 			int opt_index;
 			int opt;
@@ -160,6 +183,27 @@ program using this runtime, or may be ignored.
 						return parse_fail;
 					}
 					break;
+				case 'd':
+					on_demand = true;
+					break;
+				case 'l':
+					latency = true;
+					break;
+				case 'e':
+					coalesce = true;
+					break;
+				case 'i':
+					input_rate = parse_int(argv[0], arg, arg);
+					if(!input_rate) {
+						return parse_fail;
+					}
+					break;
+				case 'H':
+					headless = parse_int(argv[0], arg, arg);
+					if(!headless) {
+						return parse_fail;
+					}
+					break;
 				case '?':
 				case ':':
 					return parse_fail;
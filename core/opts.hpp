@@ -48,6 +48,58 @@ namespace rt {
 		extern int wstyle;
 		extern vec2i wsize;
 
+		/**
+		 * \internal
+		 * \var on_demand
+		 * \brief Only run frames when needed
+		 *
+		 * When set, main() waits for an event, a due timer or a call to
+		 * rt::redraw() before running each frame.
+		 */
+		extern bool on_demand;
+
+		/**
+		 * \internal
+		 * \var latency
+		 * \brief Measure input latency and frame timing
+		 *
+		 * When set, main() records the histograms in latency.hpp, and
+		 * prints them on exit.
+		 */
+		extern bool latency;
+
+		/**
+		 * \internal
+		 * \var coalesce
+		 * \brief Coalesce mouse moves, resizes and joystick moves
+		 *
+		 * When set, main() sets event_queue::coalesce, so only the latest
+		 * of consecutive moves or resizes is handled.
+		 */
+		extern bool coalesce;
+
+		/**
+		 * \internal
+		 * \var input_rate
+		 * \brief Rate to sample input at on a separate thread
+		 *
+		 * When set, main() runs input::background_sampler at this many
+		 * samples a second.
+		 */
+		extern stx::optional<int> input_rate;
+
+		/**
+		 * \internal
+		 * \var headless
+		 * \brief Frames to draw without a window
+		 *
+		 * When set, main() sets stdwindow::headless, so the program
+		 * draws into a disp::soft_target, and exits after this many
+		 * frames. Only programs which draw through stdwindow::render()
+		 * can run this way.
+		 */
+		extern stx::optional<int> headless;
+
 		enum opt_result
 		{
 			parse_success,
@@ -5,8 +5,12 @@
 
 #include "core/time.hpp"
 #include "core/event.hpp"
+#include "core/latency.hpp"
 #include "core/opts.hpp"
 #include "disp/window.hpp"
+#include "include/fmt.hpp"
+#include "input/sampler.hpp"
+#include "input/snapshot.hpp"
 
 namespace rt {
 
@@ -24,6 +28,7 @@ namespace rt {
 
 	signal<> on_cleanup;
 	signal<const sf::Event&> on_win_event;
+	signal<const sf::Event&> on_event[sf::Event::Count];
 	signal<> on_frame;
 
 	unsigned long long frame;
@@ -34,10 +39,64 @@ namespace rt {
 
 	std::vector<char*> args;
 
+	namespace { // anonymous
+
+		bool redraw_pending = true;
+
+		// how often events are checked while sleeping until a timer
+		const auto event_poll_interval = std::chrono::milliseconds(5);
+
+		void handle_event(const sf::Event& event)
+		{
+			if(opt::latency) {
+				latency::event_polled(event, clock::now());
+			}
+
+			input::frame_keys.process(event);
+			rt::on_win_event(event);
+			if(event.type < sf::Event::Count) {
+				rt::on_event[event.type](event);
+			}
+
+			// always close and exit
+			if(event.type == sf::Event::Closed) {
+				if(stdwin) {
+					stdwin->close();
+				}
+				rt::exit(0);
+			}
+		}
+
+		// block until an event, a due timer, or a requested redraw
+		// the event is left for the frame's event loop
+		void wait_for_work()
+		{
+			// without a window, there are no events to wait for
+			if(redraw_pending || stdwindow::headless) {
+				return;
+			}
+
+			auto deadline = next_deadline();
+			if(deadline == clock::time_point::max()) {
+				event_queue::wait(stdwin);
+			} else {
+				event_queue::wait(stdwin, deadline, event_poll_interval);
+			}
+		}
+
+	} // namespace anonymous
+
+	void redraw()
+	{
+		redraw_pending = true;
+	}
+
 } // namespace rt
 
 int main(int argc, char** argv) try
 {
+	rt::start_time = rt::clock::now();
+
 	rt::argc = argc;
 	rt::argv = argv;
 	rt::pgname = argv[0];
@@ -53,6 +112,12 @@ int main(int argc, char** argv) try
 	stdwindow::winstyle = rt::opt::wstyle;
 	stdwindow::winfps = rt::opt::wfps.value_or(0);
 	stdwindow::winsize = rt::opt::wsize;
+	stdwindow::headless = bool(rt::opt::headless);
+	event_queue::coalesce = rt::opt::coalesce;
+
+	if(rt::opt::latency) {
+		stdwindow::on_display.connect(rt::latency::presented);
+	}
 
 	int exit_code = 0;
 	try {
@@ -61,29 +126,61 @@ int main(int argc, char** argv) try
 			stdwin.init();
 		}
 
+		if(rt::opt::input_rate && !stdwindow::headless) {
+			rt::on_event[sf::Event::LostFocus].connect([] (const sf::Event&) {
+					input::background_sampler.set_focus(false);
+				});
+			rt::on_event[sf::Event::GainedFocus].connect([] (const sf::Event&) {
+					input::background_sampler.set_focus(true);
+				});
+			input::background_sampler.set_focus(stdwin->hasFocus());
+			input::background_sampler.start(stdwin.window(), *rt::opt::input_rate);
+		}
+
 		while(stdwin) {
 			try {
+				// key presses and releases from here on are this frame's
+				input::frame_keys.advance();
+
+				if(rt::opt::on_demand) {
+					rt::wait_for_work();
+					rt::redraw_pending = false;
+				}
+
 				// frame time, see time.hpp
 				rt::frame_now = rt::clock::now();
 
 				// event loop, see event.hpp for details on event_queue
-				for(auto&& event : event_queue(stdwin)) {
-					rt::on_win_event(event);
-
-					// always close and exit
-					if(event.type == sf::Event::Closed) {
-						if(stdwin) {
-							stdwin->close();
-						}
-						rt::exit(0);
+				if(!stdwindow::headless) {
+					for(auto&& event : event_queue(stdwin)) {
+						rt::handle_event(event);
 					}
 				}
+				auto exec_start = rt::clock::now();
+
 				// delayed execution, see time.hpp
 				rt::exec_step();
+				auto frame_start = rt::clock::now();
 
 				rt::on_frame();
 
+				if(rt::opt::latency) {
+					auto frame_end = rt::clock::now();
+					rt::latency::phase_done(rt::latency::phase_poll, exec_start - rt::frame_now);
+					rt::latency::phase_done(rt::latency::phase_exec, frame_start - exec_start);
+					rt::latency::phase_done(rt::latency::phase_frame,
+					                        frame_end - frame_start - rt::latency::take_display_time());
+				}
+
+				if(rt::frame == 0) {
+					rt::first_frame_time = rt::clock::now() - rt::start_time;
+				}
+
 				++rt::frame;
+
+				if(rt::opt::headless && rt::frame >= static_cast<unsigned long long>(*rt::opt::headless)) {
+					rt::exit(0);
+				}
 			} catch(const rt::detail::skipframe_signaller& e) {
 				(void)(e);
 				// go to next frame
@@ -100,6 +197,21 @@ int main(int argc, char** argv) try
 	} catch(const rt::detail::exit_signaller& e) {
 		exit_code = e.exit_code;
 	}
+	input::background_sampler.stop();
+
+	if(rt::opt::latency) {
+		rt::latency::report(std::cout);
+
+		auto& stats = event_queue::stats;
+		fmt::print(std::cout, "events: {} polled, {} handled, dropped {} mouse moves, {} resizes, {} joystick moves\n",
+		           stats.polled, stats.delivered, stats.mouse_moved, stats.resized, stats.joystick_moved);
+
+		if(rt::opt::input_rate) {
+			auto samples = input::background_sampler.get_stats();
+			fmt::print(std::cout, "input thread: {} samples, {} events, {} dropped\n",
+			           samples.samples, samples.events, samples.dropped);
+		}
+	}
 
 	return exit_code;
 } catch(const std::exception& e) {
@@ -90,6 +90,18 @@ namespace rt {
 	void skipframe()
 		noexcept(false);
 
+	/**
+	 * \fn redraw
+	 * \brief Request another frame
+	 *
+	 * With the on-demand option (see opts.hpp), frames only run after an
+	 * event or a due timer (see time.hpp). Call this from a frame or
+	 * anywhere else on the main thread when something has changed which
+	 * needs a frame, e.g. every frame while animating. Without the option,
+	 * every frame runs, and this does nothing.
+	 */
+	void redraw();
+
 	/**
 	 * \var on_cleanup
 	 * \brief Program cleanup hook
@@ -110,9 +122,25 @@ namespace rt {
 	 *
 	 * Note that the window close event has an extra special handler which
 	 * is always triggered after all user-defined events.
+	 *
+	 * Prefer on_event for handling only some types of event.
 	 */
 	extern signal<const sf::Event&> on_win_event;
 
+	/**
+	 * \var on_event
+	 * \brief Window event hooks, by event type
+	 *
+	 * This is indexed by sf::Event::EventType, and each signal is only
+	 * triggered for events of that type, after on_win_event, e.g.
+	 *
+	 *     rt::on_event[sf::Event::KeyPressed].connect(fn);
+	 *
+	 * Slots don't need to check the type, and are not called for the many
+	 * events they don't handle, such as mouse movement.
+	 */
+	extern signal<const sf::Event&> on_event[sf::Event::Count];
+
 	/**
 	 * \var on_frame
 	 * \brief Per-frame hook
@@ -30,6 +30,8 @@ namespace { // anonymous
 namespace rt {
 
 	clock::time_point frame_now{};
+	clock::time_point start_time{};
+	clock::duration first_frame_time{};
 
 	void exec_at(clock::time_point when, std::function<void()> fn)
 	{
@@ -65,4 +67,15 @@ namespace rt {
 		until_queue.erase(until_queue.begin(), exec_until_end);
 	}
 
+	clock::time_point next_deadline()
+	{
+		if(!until_queue.empty()) {
+			return frame_now;
+		}
+		if(!at_queue.empty()) {
+			return at_queue.top().when;
+		}
+		return clock::time_point::max();
+	}
+
 } // namespace rt
@@ -1,4 +1,5 @@
 /* -*- cpp.doxygen -*- */
+#pragma once
 
 #include <chrono>
 #include <functional>
@@ -32,6 +33,19 @@ namespace rt {
 	 */
 	extern clock::time_point frame_now;
 
+	/**
+	 * \var start_time
+	 * \var first_frame_time
+	 * \brief Startup timing
+	 *
+	 * start_time is set at the beginning of main(), and first_frame_time
+	 * to the time taken until the end of the first frame (including
+	 * initial()). first_frame_time is zero until then. These are set by
+	 * the runtime, and are useful to measure startup costs.
+	 */
+	extern clock::time_point start_time;
+	extern clock::duration first_frame_time;
+
 	/**
 	 * \fn exec_at
 	 * \brief Call a function at specified point in time
@@ -65,4 +79,14 @@ namespace rt {
 	 */
 	void exec_step();
 
+	/**
+	 * \fn next_deadline
+	 * \brief Time exec_step() next has work to do
+	 *
+	 * This is the earliest time given to exec_at(), or #frame_now if
+	 * there are functions from exec_until() to call every tick. If nothing
+	 * is waiting, clock::time_point::max() is returned.
+	 */
+	clock::time_point next_deadline();
+
 } // namespace rt
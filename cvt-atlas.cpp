@@ -0,0 +1,149 @@
+// a tool to pack images into texture atlases, to be embedded with cvt-export
+// argv: header, namespace, page size, page prefix, page count, files...
+// pages are written to <page prefix><index>.png
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <sfml/graphics/image.hpp>
+
+#include "cvt-common.hpp"
+#include "include/fmt.hpp"
+#include "res/atlas.hpp"
+
+// space between sprites, so filtering does not bleed into neighbours
+constexpr unsigned padding = 1;
+
+std::fstream o_head;
+
+int main(int argc, char** argv)
+{
+	if(argc <= 5) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "insufficient arguments");
+		return 1;
+	}
+
+	unsigned page_size = 0;
+	unsigned page_count = 0;
+	try {
+		page_size = std::stoul(argv[3]);
+		page_count = std::stoul(argv[5]);
+	} catch(const std::exception&) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "invalid page size or count");
+		return 1;
+	}
+	if(page_size == 0 || page_size > 0xffff || page_count == 0) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "invalid page size or count");
+		return 1;
+	}
+
+	std::cout << "Creating atlas " << argv[2] << '\n'
+		<< "hdr: " << argv[1] << '\n';
+
+	std::vector<sf::Image> images(argc - 6);
+	for(int i = 6; i < argc; ++i) {
+		if(!images[i - 6].loadFromFile(argv[i])) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[i], "cannot load image");
+			return 1;
+		}
+	}
+
+	// tallest first packs much better with a skyline
+	std::vector<size_t> order(images.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&] (size_t a, size_t b) {
+			return images[a].getSize().y > images[b].getSize().y;
+		});
+
+	std::vector<res::atlas_rect> rects(images.size());
+	std::vector<res::skyline_packer> pages;
+
+	for(auto idx : order) {
+		auto size = images[idx].getSize();
+		auto w = size.x + padding;
+		auto h = size.y + padding;
+
+		stx::optional<res::skyline_packer::point> at;
+		size_t page = 0;
+		for(; page < pages.size() && !at; ++page) {
+			at = pages[page].insert(w, h);
+		}
+		if(!at) {
+			pages.emplace_back(page_size, page_size);
+			page = pages.size();
+			at = pages.back().insert(w, h);
+		}
+		if(!at) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[idx + 6], "larger than page size");
+			return 1;
+		}
+		if(pages.size() > page_count) {
+			fmt::print(std::cerr, "{}: {}\n", argv[0], "more pages required than requested");
+			return 1;
+		}
+
+		rects[idx] = res::atlas_rect{
+			uint16_t(page - 1), uint16_t(at->x), uint16_t(at->y),
+			uint16_t(size.x), uint16_t(size.y)
+		};
+	}
+
+	// write pages, including empty ones so the build sees every output
+	for(size_t page = 0; page < page_count; ++page) {
+		sf::Image out;
+		if(page < pages.size()) {
+			out.create(page_size, page_size, sf::Color::Transparent);
+			fmt::print("page {}: {:.1f}% used\n", page, pages[page].occupancy() * 100);
+		} else {
+			out.create(1, 1, sf::Color::Transparent);
+		}
+
+		for(size_t i = 0; i < images.size(); ++i) {
+			if(rects[i].page == page) {
+				out.copy(images[i], rects[i].left, rects[i].top);
+			}
+		}
+
+		auto fname = fmt::format("{}{}.png", argv[4], page);
+		if(!out.saveToFile(fname)) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], fname, "cannot save image");
+			return 1;
+		}
+	}
+
+	o_head.open(argv[1], std::ofstream::out | std::ofstream::trunc);
+	if(!o_head) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], std::strerror(errno));
+		return 1;
+	}
+
+	fmt::print(o_head,
+R"(#pragma once
+// auto-generated header file from cvt-atlas
+// do not directly modify
+
+#include "res/atlas.hpp"
+
+namespace store {{
+
+namespace {} {{
+
+	constexpr unsigned page_count = {};
+	constexpr unsigned page_size = {};
+
+)", argv[2], pages.size(), page_size);
+
+	for(size_t i = 0; i < images.size(); ++i) {
+		const auto& r = rects[i];
+		fmt::print(o_head, "\tconstexpr res::atlas_rect {}{{ {}, {}, {}, {}, {} }};\n",
+			fname_to_ident(argv[i + 6]), r.page, r.left, r.top, r.width, r.height);
+	}
+
+	fmt::print(o_head, "\n}} // namespace {}\n\n}} // namespace store", argv[2]);
+}
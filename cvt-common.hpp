@@ -0,0 +1,51 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <algorithm>
+#include <locale>
+#include <string>
+
+/**
+ * \file
+ * \brief Helpers shared by the cvt-* tools
+ */
+
+/**
+ * \fn fname_to_ident
+ * \brief Identifier for a resource file
+ *
+ * This takes the file name without the directory, adds \p prefix, and
+ * replaces anything not alphanumeric with underscores, e.g. "store/knight.png"
+ * becomes "knight_png". The generated symbols and wrappers must agree on this.
+ */
+inline std::string fname_to_ident(std::string s, const std::string& prefix = "")
+{
+	size_t last_sep = s.find_last_of("\\/", s.size() - 1);
+	s = prefix + (last_sep == std::string::npos ? s : s.substr(last_sep + 1));
+	auto xform_fn = [](char c) {
+		if(!(std::isalnum(c, std::locale::classic()))) {
+			return '_';
+		}
+		return std::tolower(c, std::locale::classic());
+	};
+
+	std::transform(s.begin(), s.end(), s.begin(), xform_fn);
+	return s;
+}
+
+
+/**
+ * \fn symbol_prefix
+ * \brief Prefix of the symbols exported by a resource library
+ *
+ * Each library given to res_export has its own prefix, so several can be
+ * linked together, e.g. the symbols of res0_res are named res0_knight_png.
+ */
+inline std::string symbol_prefix(std::string lib_name)
+{
+	const std::string suffix = "_res";
+	if(lib_name.size() > suffix.size() && lib_name.compare(lib_name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+		lib_name.resize(lib_name.size() - suffix.size());
+	}
+	return fname_to_ident(lib_name) + "_";
+}
@@ -1,33 +1,77 @@
 // an internal tool to convert raw resources (e.g .images) to files
 // argv: source, header, project name, files...
+// a file preceded by -z is stored compressed (see res/lz.hpp)
+// each file is written to its own source (a chunk) beside the given source,
+// which is only rewritten when the contents change, and identical files
+// share the same symbol
+// chunks and the source declare their own symbols instead of including the
+// header, which changes with any file, so a changed file only recompiles its
+// chunk (and the small source, if its size changed)
 
 #include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <locale>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 #include <cerrno>
 #include <cstring>
 
+#include "cvt-common.hpp"
 #include "include/fmt.hpp"
+#include "res/lz.hpp"
 #include "res/memfile.hpp"
 
-std::string fname_to_ident(std::string s)
+// 64-bit FNV-1a, to detect changed and identical files
+uint64_t content_hash(const uint8_t* data, uint64_t size)
 {
-	size_t last_sep = s.find_last_of("\\/", s.size() - 1);
-	s = "res0_" + (last_sep == std::string::npos ? s : s.substr(last_sep + 1));
-	auto xform_fn = [](char c) {
-		if(!(std::isalnum(c, std::locale::classic()))) {
-			return '_';
-		}
-		return std::tolower(c, std::locale::classic());
-	};
+	uint64_t hash = 0xcbf29ce484222325;
+	for(auto ptr = data, end = data + size; ptr != end; ++ptr) {
+		hash = (hash ^ *ptr) * 0x100000001b3;
+	}
+	return hash;
+}
+
+std::string read_file(const std::string& fname)
+{
+	std::ifstream in(fname, std::ifstream::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string read_first_line(const std::string& fname)
+{
+	std::ifstream in(fname);
+	std::string line;
+	std::getline(in, line);
+	return line;
+}
+
+// leaves the file (and its timestamp) alone if the contents are the same
+bool write_if_changed(const std::string& fname, const std::string& contents)
+{
+	if(read_file(fname) == contents) {
+		return true;
+	}
 
-	std::transform(s.begin(), s.end(), s.begin(), xform_fn);
-	return s;
+	std::ofstream out(fname, std::ofstream::binary | std::ofstream::trunc);
+	out << contents;
+	return bool(out);
 }
 
-std::fstream o_src, o_head;
+// a resource to be embedded
+struct blob
+{
+	std::string fname;
+	std::string ident;
+	std::unique_ptr<res::ro_memfile> file;
+	std::vector<uint8_t> compressed;
+	const uint8_t* data;
+	uint64_t size;
+	uint64_t hash;
+	const blob* alias_of;
+};
 
 int main(int argc, char** argv)
 {
@@ -40,73 +84,219 @@ int main(int argc, char** argv)
 		<< "src: " << argv[1] << '\n'
 		<< "hdr: " << argv[2] << '\n';
 
-	o_src.open(argv[1], std::ofstream::out | std::ofstream::trunc);
-	if(!o_src) {
-		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], std::strerror(errno));
-		return 1;
-	}
+	// chunks are named after the source, e.g. res0_lib.cpp has res0_lib_knight_png.cpp
+	std::string src_name = argv[1];
+	std::string chunk_prefix = src_name.substr(0, src_name.rfind('.')) + "_";
+	std::string ident_prefix = symbol_prefix(argv[3]);
 
+	std::vector<std::unique_ptr<blob>> blobs;
+	std::multimap<uint64_t, const blob*> by_hash;
 
-	o_head.open(argv[2], std::ofstream::out | std::ofstream::trunc);
-	if(!o_src) {
-		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[2], std::strerror(errno));
-		return 1;
+	for(int i = 4; i < argc; ++i) {
+		bool compress = argv[i] == std::string("-z");
+		if(compress && ++i == argc) {
+			fmt::print(std::cerr, "{}: {}\n", argv[0], "-z requires a file");
+			return 1;
+		}
+
+		std::unique_ptr<blob> b(new blob());
+		b->fname = argv[i];
+		b->ident = fname_to_ident(argv[i], ident_prefix);
+		b->file.reset(new res::ro_memfile());
+
+		std::error_code ec;
+		if(!b->file->open(argv[i], ec)) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[i], ec.message());
+			return 1;
+		}
+
+		b->data = static_cast<const uint8_t*>(b->file->get());
+		b->size = b->file->size();
+
+		if(compress) {
+			b->compressed = res::lz_compress(b->data, b->size);
+			fmt::print("{}: {} -> {} bytes\n", argv[i], b->size, b->compressed.size());
+			b->data = b->compressed.data();
+			b->size = b->compressed.size();
+		}
+
+		b->hash = content_hash(b->data, b->size);
+		b->alias_of = nullptr;
+
+		// identical contents share the first symbol
+		auto range = by_hash.equal_range(b->hash);
+		for(auto it = range.first; it != range.second; ++it) {
+			auto other = it->second;
+			if(other->size == b->size && std::equal(b->data, b->data + b->size, other->data)) {
+				b->alias_of = other;
+				fmt::print("{}: same as {}\n", argv[i], other->fname);
+				break;
+			}
+		}
+		if(!b->alias_of) {
+			by_hash.emplace(b->hash, b.get());
+		}
+
+		blobs.push_back(std::move(b));
 	}
 
+	// what the header, source and chunks need for the symbols
+	std::string preamble = fmt::format(
+R"(#ifdef {0}_EXPORTS
+#define EXPORTS
+#endif
+
+#include "res/dllport.hpp"
+#include "include/types.hpp"
+)", argv[3]);
+	const char* postamble = "\n#ifdef EXPORTS\n#undef EXPORTS\n#endif";
+
+	std::ostringstream o_src, o_head;
+
 	fmt::print(o_src,
-R"(#include "{}"
-// auto-generated source file from cvt-export
+R"(// auto-generated source file from cvt-export
 // do not directly modify
+// the resources are in separate chunks, so only changed files are recompiled
 
+#include <cstring>
+
+{}
 extern "C" {{
 
-)", argv[2]);
+	_dll_api_ const uint8_t* {}_lookup(const char* name, uint64_t* size);
 
+)", preamble, argv[3]);
 
 	fmt::print(o_head,
 R"(#pragma once
 // auto-generated header file from cvt-export
 // do not directly modify
 
-#ifdef {}_EXPORTS
-#define EXPORTS
-#endif
+{}
+extern "C" {{
 
-#include "res/dllport.hpp"
-#include "include/types.hpp"
+	// find a resource by its symbol name, for loading the library at runtime
+	_dll_api_ const uint8_t* {}_lookup(const char* name, uint64_t* size);
 
-extern "C" {{
+)", preamble, argv[3]);
 
-)", argv[3]);
+	size_t written = 0;
+	for(auto& b : blobs) {
+		auto chunk_name = chunk_prefix + b->ident.substr(ident_prefix.size()) + ".cpp";
 
-	for(int i = 4; i < argc; ++i) {
-		res::ro_memfile raw_file;
-		std::error_code ec;
+		if(b->alias_of) {
+			fmt::print(o_src, "\t// {}: alias of {}\n", b->ident, b->alias_of->ident);
+		} else {
+			fmt::print(o_src, "\t// in {}\n", chunk_name);
+			fmt::print(o_src, "\t_dll_api_ byte_block<{}> {};\n", b->size, b->ident);
+			fmt::print(o_head, "\t_dll_api_ byte_block<{}> {};\n", b->size, b->ident);
+		}
 
-		if(!raw_file.open(argv[i], ec)) {
-			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[i], ec.message());
-			return 1;
+		// the first line identifies the contents, so unchanged chunks can be skipped
+		std::string tag = b->alias_of
+			? fmt::format("// cvt-export 2 alias {}", b->alias_of->ident)
+			: fmt::format("// cvt-export 2 fnv1a:{:016x} size:{}", b->hash, b->size);
+		if(read_first_line(chunk_name) == tag) {
+			continue;
 		}
 
-		auto ident = fname_to_ident(argv[i]);
+		std::ostringstream o_chunk;
+		fmt::print(o_chunk, "{}\n", tag);
+		if(!b->alias_of) {
+			fmt::print(o_chunk,
+R"(// auto-generated source file from cvt-export
+// do not directly modify
+
+{}
+extern "C" {{
 
-		fmt::print(o_head, "\t_dll_api_ byte_block<{}> {};\n", raw_file.size(), ident);
-		fmt::print(o_src,  "\t_dll_api_ byte_block<{}> {} = {{", raw_file.size(), ident);
+)", preamble);
 
-		size_t counter = 0;
-		for(auto ptr = static_cast<const unsigned char*>(raw_file.get()), end = ptr + raw_file.size();
-		    ptr != end; ++ptr, ++counter) {
-			if(counter % 32 == 0) {
-				o_src << '\n';
-				counter = 0;
+			fmt::print(o_chunk, "\t_dll_api_ byte_block<{}> {} = {{", b->size, b->ident);
+
+			size_t counter = 0;
+			for(auto ptr = b->data, end = ptr + b->size;
+			    ptr != end; ++ptr, ++counter) {
+				if(counter % 32 == 0) {
+					o_chunk << '\n';
+					counter = 0;
+				}
+				fmt::print(o_chunk, " {:>3},", *ptr);
 			}
-			fmt::print(o_src, " {:>3},", *ptr);
+
+			fmt::print(o_chunk, "\n\t}};\n\n}}\n{}", postamble);
+		}
+
+		if(!write_if_changed(chunk_name, o_chunk.str())) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], chunk_name, std::strerror(errno));
+			return 1;
 		}
+		++written;
+	}
+
+	fmt::print(o_src, "\n}}\n\n");
+	for(auto& b : blobs) {
+		if(b->alias_of) {
+			fmt::print(o_src, "static byte_block<{}>& {} = {};\n", b->size, b->ident, b->alias_of->ident);
+		}
+	}
+
+	fmt::print(o_src, R"(
+namespace {{
+
+	struct lookup_entry
+	{{
+		const char* name;
+		const uint8_t* data;
+		uint64_t size;
+	}};
+
+	const lookup_entry lookup_table[] = {{
+)");
+	for(auto& b : blobs) {
+		fmt::print(o_src, "\t\t{{\"{0}\", {0}, sizeof({0})}},\n", b->ident);
+	}
+	fmt::print(o_src, R"(		{{nullptr, nullptr, 0}}
+	}};
+
+}} // namespace anonymous
+
+extern "C" {{
 
-		fmt::print(o_src, "\n\t}};\n\n");
+	_dll_api_ const uint8_t* {}_lookup(const char* name, uint64_t* size)
+	{{
+		for(auto entry = lookup_table; entry->name; ++entry) {{
+			if(std::strcmp(entry->name, name) == 0) {{
+				*size = entry->size;
+				return entry->data;
+			}}
+		}}
+		return nullptr;
+	}}
+
+}}
+{}
+)", argv[3], postamble);
+
+	fmt::print(o_head, "\n}}\n");
+
+	// duplicates refer to the original, without a symbol of their own
+	for(auto& b : blobs) {
+		if(b->alias_of) {
+			fmt::print(o_head, "static byte_block<{}>& {} = {};\n", b->size, b->ident, b->alias_of->ident);
+		}
 	}
 
-	fmt::print(o_head, "\n}}\n#ifdef EXPORTS\n#undef EXPORTS\n#endif");
-	fmt::print(o_src, "}}");
+	fmt::print(o_head, "{}", postamble);
+
+	if(!write_if_changed(argv[1], o_src.str())) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], std::strerror(errno));
+		return 1;
+	}
+	if(!write_if_changed(argv[2], o_head.str())) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[2], std::strerror(errno));
+		return 1;
+	}
 
+	fmt::print("{} of {} chunks regenerated\n", written, blobs.size());
 }
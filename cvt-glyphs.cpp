@@ -0,0 +1,252 @@
+// a tool to rasterise a font into a glyph atlas and metrics table, so text can
+// be drawn without rasterising at runtime
+// glyphs are rendered with FreeType directly, as sf::Font needs an OpenGL
+// context for its textures, which build hosts may not have
+// argv: header, namespace, page file, font, sizes (e.g. 16,30), characters (e.g. 32-126)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <sfml/graphics/image.hpp>
+
+#include "include/fmt.hpp"
+#include "res/atlas.hpp"
+
+// space between glyphs, so filtering does not bleed into neighbours
+constexpr unsigned padding = 1;
+constexpr unsigned max_page_size = 4096;
+
+// metrics are as in sf::Glyph, relative to the baseline at the pen position
+struct baked_glyph
+{
+	uint32_t codepoint;
+	float advance;
+	int left;
+	int top;
+	unsigned width;
+	unsigned height;
+	std::vector<uint8_t> coverage; // alpha of each pixel, by rows
+	res::atlas_rect rect;
+};
+
+struct baked_size
+{
+	unsigned int size;
+	float line_spacing;
+	std::vector<baked_glyph> glyphs;
+};
+
+// render a glyph as sf::Font does, with the auto-hinter and antialiasing
+bool render_glyph(FT_Face face, uint32_t codepoint, baked_glyph& out)
+{
+	out.codepoint = codepoint;
+	if(FT_Load_Char(face, codepoint, FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT) != 0) {
+		return false;
+	}
+	FT_GlyphSlot slot = face->glyph;
+	if(FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0) {
+		return false;
+	}
+
+	out.advance = float(slot->metrics.horiAdvance >> 6);
+	out.left = slot->bitmap_left;
+	out.top = -slot->bitmap_top;
+	out.width = slot->bitmap.width;
+	out.height = slot->bitmap.rows;
+
+	const FT_Bitmap& bitmap = slot->bitmap;
+	out.coverage.resize(size_t(out.width) * out.height);
+	for(unsigned y = 0; y < out.height; ++y) {
+		const unsigned char* row = bitmap.buffer + y * bitmap.pitch;
+		for(unsigned x = 0; x < out.width; ++x) {
+			uint8_t alpha;
+			if(bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+				alpha = (row[x / 8] & (0x80 >> (x % 8))) ? 255 : 0;
+			} else {
+				alpha = row[x];
+			}
+			out.coverage[size_t(y) * out.width + x] = alpha;
+		}
+	}
+	return true;
+}
+
+std::vector<unsigned long> parse_list(const std::string& s)
+{
+	std::vector<unsigned long> out;
+	size_t pos = 0;
+	while(pos < s.size()) {
+		auto end = s.find(',', pos);
+		if(end == std::string::npos) {
+			end = s.size();
+		}
+		out.push_back(std::stoul(s.substr(pos, end - pos)));
+		pos = end + 1;
+	}
+	return out;
+}
+
+std::fstream o_head;
+
+int main(int argc, char** argv)
+{
+	if(argc <= 6) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "insufficient arguments");
+		return 1;
+	}
+
+	std::vector<unsigned long> sizes;
+	unsigned long first_char = 0;
+	unsigned long last_char = 0;
+	try {
+		sizes = parse_list(argv[5]);
+
+		std::string range = argv[6];
+		auto split = range.find('-');
+		first_char = std::stoul(range.substr(0, split));
+		last_char = split == std::string::npos ? first_char : std::stoul(range.substr(split + 1));
+	} catch(const std::exception&) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "invalid sizes or character range");
+		return 1;
+	}
+	if(sizes.empty() || last_char < first_char) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "invalid sizes or character range");
+		return 1;
+	}
+
+	std::cout << "Creating glyphs " << argv[2] << '\n'
+		<< "hdr: " << argv[1] << '\n'
+		<< "page: " << argv[3] << '\n';
+
+	FT_Library library;
+	if(FT_Init_FreeType(&library) != 0) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "cannot initialise FreeType");
+		return 1;
+	}
+	FT_Face face;
+	if(FT_New_Face(library, argv[4], 0, &face) != 0) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[4], "cannot load font");
+		return 1;
+	}
+
+	std::vector<baked_size> baked;
+	for(auto size : sizes) {
+		if(FT_Set_Pixel_Sizes(face, 0, FT_UInt(size)) != 0) {
+			fmt::print(std::cerr, "{}: {}: {} {}\n", argv[0], argv[4], "cannot use size", size);
+			return 1;
+		}
+
+		baked_size bs;
+		bs.size = size;
+		bs.line_spacing = float(face->size->metrics.height) / 64;
+		for(auto cp = first_char; cp <= last_char; ++cp) {
+			baked_glyph g;
+			if(!render_glyph(face, uint32_t(cp), g)) {
+				fmt::print(std::cerr, "{}: {}: {} {}\n", argv[0], argv[4], "cannot render character", cp);
+				return 1;
+			}
+			bs.glyphs.push_back(std::move(g));
+		}
+		baked.push_back(std::move(bs));
+	}
+
+	FT_Done_Face(face);
+	FT_Done_FreeType(library);
+
+	// place the glyphs in the smallest square page they fit in
+	std::vector<baked_glyph*> order;
+	for(auto& bs : baked) {
+		for(auto& g : bs.glyphs) {
+			order.push_back(&g);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [] (const baked_glyph* a, const baked_glyph* b) {
+			return a->height > b->height;
+		});
+
+	unsigned page_size = 64;
+	for(; page_size <= max_page_size; page_size *= 2) {
+		res::skyline_packer packer(page_size, page_size);
+		bool fits = true;
+		for(auto g : order) {
+			auto at = packer.insert(g->width + padding, g->height + padding);
+			if(!at) {
+				fits = false;
+				break;
+			}
+			g->rect = res::atlas_rect{
+				0, uint16_t(at->x), uint16_t(at->y),
+				uint16_t(g->width), uint16_t(g->height)
+			};
+		}
+		if(fits) {
+			fmt::print("page: {}x{}, {:.1f}% used\n", page_size, page_size, packer.occupancy() * 100);
+			break;
+		}
+	}
+	if(page_size > max_page_size) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "glyphs do not fit in the largest page");
+		return 1;
+	}
+
+	sf::Image page;
+	page.create(page_size, page_size, sf::Color::Transparent);
+	for(auto& bs : baked) {
+		for(auto& g : bs.glyphs) {
+			// white, with the coverage as alpha, as in sf::Font's texture
+			for(unsigned y = 0; y < g.height; ++y) {
+				for(unsigned x = 0; x < g.width; ++x) {
+					uint8_t alpha = g.coverage[size_t(y) * g.width + x];
+					page.setPixel(g.rect.left + x, g.rect.top + y, sf::Color(255, 255, 255, alpha));
+				}
+			}
+		}
+	}
+	if(!page.saveToFile(argv[3])) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[3], "cannot save image");
+		return 1;
+	}
+
+	o_head.open(argv[1], std::ofstream::out | std::ofstream::trunc);
+	if(!o_head) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], std::strerror(errno));
+		return 1;
+	}
+
+	fmt::print(o_head,
+R"(#pragma once
+// auto-generated header file from cvt-glyphs
+// do not directly modify
+
+#include "res/glyphs.hpp"
+
+namespace store {{
+
+namespace {} {{
+
+	constexpr unsigned page_size = {};
+
+)", argv[2], page_size);
+
+	for(auto& bs : baked) {
+		fmt::print(o_head, "\tconstexpr res::glyph_info size_{}_glyphs[] = {{\n", bs.size);
+		for(auto& g : bs.glyphs) {
+			fmt::print(o_head, "\t\t{{ {}, {}, {}, {}, {}, {}, {{ {}, {}, {}, {}, {} }} }},\n",
+				g.codepoint, g.advance, g.left, g.top, g.width, g.height,
+				g.rect.page, g.rect.left, g.rect.top, g.rect.width, g.rect.height);
+		}
+		fmt::print(o_head, "\t}};\n");
+		fmt::print(o_head, "\tconstexpr res::glyph_set size_{0}{{ {0}, {1}, size_{0}_glyphs, {2} }};\n\n",
+			bs.size, bs.line_spacing, bs.glyphs.size());
+	}
+
+	fmt::print(o_head, "}} // namespace {}\n\n}} // namespace store", argv[2]);
+}
@@ -1,6 +1,10 @@
 // a tool to accompany cvt-export, generating memblk/memfile wrappers for raw resources
-// argv: source, header, ("file" | "export", exp-head), files...
+// argv: source, header, ("file" | "watch" | "export", exp-head, lib-name | "lazy", lib-file, lib-name), files...
+// lib-name is the project name given to cvt-export, which the symbol names are derived from
 // note: if using export, the exported header must be included prior
+// watch is the same as file, but the files can be reloaded with a res::file_watcher
+// lazy is the same as export, but the library is loaded on first use (see res/lazylib.hpp)
+// a file preceded by -z was compressed by cvt-export, and is ignored in file mode
 
 #include <algorithm>
 #include <algorithm>
@@ -8,50 +12,105 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <locale>
 #include <string>
 
+#include "cvt-common.hpp"
 #include "include/fmt.hpp"
 
-std::string fname_to_ident(std::string s)
+std::fstream o_src, o_head;
+
+void output_using_memfile(const char* type, int filec, char** filev)
 {
-	size_t last_sep = s.find_last_of("\\/", s.size() - 1);
-	s = last_sep == std::string::npos ? s : s.substr(last_sep + 1);
-	auto xform_fn = [](char c) {
-		if(!(std::isalnum(c, std::locale::classic()))) {
-			return '_';
+	for(int i = 0; i < filec; ++i) {
+		if(filev[i] == std::string("-z")) {
+			continue;
 		}
-		return std::tolower(c, std::locale::classic());
-	};
-
-	std::transform(s.begin(), s.end(), s.begin(), xform_fn);
-	return s;
+		auto ident = fname_to_ident(filev[i]);
+		fmt::print(o_head, "\textern {} {};\n", type, ident);
+		fmt::print(o_src, "\t{} {}(\"{}\");\n", type, ident, filev[i]);
+	}
 }
 
+void output_watch_all(int filec, char** filev)
+{
+	fmt::print(o_head, "\n\t// register all resources with a watcher\n");
+	fmt::print(o_head, "\tvoid watch_all(res::file_watcher& watcher);\n");
 
-std::fstream o_src, o_head;
+	fmt::print(o_src, "\n\tvoid watch_all(res::file_watcher& watcher)\n\t{{\n");
+	for(int i = 0; i < filec; ++i) {
+		if(filev[i] == std::string("-z")) {
+			continue;
+		}
+		fmt::print(o_src, "\t\twatcher.watch({});\n", fname_to_ident(filev[i]));
+	}
+	fmt::print(o_src, "\t}}\n");
+}
 
-void output_using_memfile(int filec, char** filev)
+void output_using_lazy(const char* lib_file, const char* lib_name, int filec, char** filev)
 {
+	// named after the library, so several lazy libraries can be linked together
+	auto library = symbol_prefix(lib_name) + "library";
+	fmt::print(o_head, "\textern res::lazy_library {};\n\n", library);
+	fmt::print(o_src, "\tres::lazy_library {}(\"{}\", \"{}_lookup\");\n\n", library, lib_file, lib_name);
+
 	for(int i = 0; i < filec; ++i) {
+		const char* type = "res::lazy_memblk";
+		if(filev[i] == std::string("-z") && i + 1 < filec) {
+			type = "res::lazy_compressed_memblk";
+			++i;
+		}
 		auto ident = fname_to_ident(filev[i]);
-		fmt::print(o_head, "\textern res::ro_memfile {};\n", ident);
-		fmt::print(o_src, "\tres::ro_memfile {}(\"{}\");\n", ident, filev[i]);
+		fmt::print(o_head, "\textern {} {};\n", type, ident);
+		fmt::print(o_src, "\t{} {}({}, \"{}\");\n", type, ident, library, symbol_prefix(lib_name) + ident);
 	}
 }
 
-void output_using_memblk(int filec, char** filev)
+void output_using_memblk(const char* lib_name, int filec, char** filev)
 {
 	for(int i = 0; i < filec; ++i) {
+		const char* type = "res::ro_memblk";
+		if(filev[i] == std::string("-z") && i + 1 < filec) {
+			type = "res::compressed_memblk";
+			++i;
+		}
 		auto ident = fname_to_ident(filev[i]);
-		fmt::print(o_head, "\textern res::ro_memblk {};\n", ident);
-		fmt::print(o_src, "\tres::ro_memblk {}({});\n", ident, "res0_" + ident);
+		fmt::print(o_head, "\textern {} {};\n", type, ident);
+		fmt::print(o_src, "\t{} {}({});\n", type, ident, symbol_prefix(lib_name) + ident);
 	}
 }
 
-void output_type(bool use_memfile, int argc, char** argv)
+enum wrap_mode
+{
+	mode_file,
+	mode_watch,
+	mode_export,
+	mode_lazy
+};
+
+void output_type(wrap_mode mode, int argc, char** argv)
 {
-	if(!use_memfile) {
+	const char* type = nullptr;
+	const char* type_header = nullptr;
+	switch(mode) {
+	case mode_file:
+		type = "res::ro_memfile";
+		type_header = "memfile.hpp";
+		break;
+	case mode_watch:
+		type = "res::hot_memfile";
+		type_header = "watcher.hpp";
+		break;
+	case mode_export:
+		type = "res::ro_memblk";
+		type_header = "memblk.hpp";
+		break;
+	case mode_lazy:
+		type = "res::lazy_memblk";
+		type_header = "lazylib.hpp";
+		break;
+	}
+
+	if(mode == mode_export) {
 		fmt::print(o_src, "#include \"{}\"\n", argv[4]);
 	}
 
@@ -70,17 +129,28 @@ R"(#pragma once
 // do not directly modify
 
 #include "res/{}"
+#include "res/compressed.hpp"
 
 namespace store {{
 
 	using resource_type = {};
 
-)", use_memfile ? "memfile.hpp" : "memblk.hpp", use_memfile ? "res::ro_memfile" : "res::ro_memblk");
-
-	if(use_memfile) {
-		output_using_memfile(argc - 4, argv + 4);
-	} else {
-		output_using_memblk(argc - 5, argv + 5);
+)", type_header, type);
+
+	switch(mode) {
+	case mode_file:
+		output_using_memfile(type, argc - 4, argv + 4);
+		break;
+	case mode_watch:
+		output_using_memfile(type, argc - 4, argv + 4);
+		output_watch_all(argc - 4, argv + 4);
+		break;
+	case mode_export:
+		output_using_memblk(argv[5], argc - 6, argv + 6);
+		break;
+	case mode_lazy:
+		output_using_lazy(argv[4], argv[5], argc - 6, argv + 6);
+		break;
 	}
 
 	fmt::print(o_src, "\n}} // namespace store");
@@ -94,17 +164,24 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	bool use_memfile;
+	wrap_mode mode;
+	int min_args = 3;
 	if(argv[3] == std::string("file")) {
-		use_memfile = true;
+		mode = mode_file;
+	} else if(argv[3] == std::string("watch")) {
+		mode = mode_watch;
 	} else if(argv[3] == std::string("export")) {
-		use_memfile = false;
+		mode = mode_export;
+		min_args = 5;
+	} else if(argv[3] == std::string("lazy")) {
+		mode = mode_lazy;
+		min_args = 5;
 	} else {
 		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[3], "invalid type");
 		return 1;
 	}
 
-	if(!use_memfile && argc <= 4) {
+	if(argc <= min_args) {
 		fmt::print(std::cerr, "{}: {}\n", argv[0], "insufficient arguments");
 		return 1;
 	}
@@ -125,6 +202,6 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	output_type(use_memfile, argc, argv);
+	output_type(mode, argc, argv);
 
 }
@@ -0,0 +1,263 @@
+#include "command_buffer.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include <sfml/graphics/rendertarget.hpp>
+
+namespace disp {
+
+	// class command_buffer {{{
+
+	command_buffer::command_buffer()
+		: vertices(), commands(), blends()
+		, sorted(), runs(), order(), compiled(true)
+	{
+	}
+
+	uint32_t command_buffer::blend_index(const sf::BlendMode& blend)
+	{
+		// there are rarely more than a couple of blend modes in a frame
+		for(size_t i = 0; i < blends.size(); ++i) {
+			if(blends[i] == blend) {
+				return uint32_t(i);
+			}
+		}
+		blends.push_back(blend);
+		return uint32_t(blends.size() - 1);
+	}
+
+	sf::Vertex* command_buffer::record(size_t count, sf::PrimitiveType type, const sf::Texture* texture,
+	                                   const sf::BlendMode& blend, uint32_t layer)
+	{
+		uint32_t blend_id = this->blend_index(blend);
+		if(commands.empty()
+		|| commands.back().layer != layer || commands.back().blend != blend_id
+		|| commands.back().texture != texture || commands.back().type != type) {
+			commands.push_back(command{layer, blend_id, texture, type, vertices.size(), 0});
+		}
+		commands.back().count += count;
+		compiled = false;
+
+		vertices.resize(vertices.size() + count);
+		return &vertices[vertices.size() - count];
+	}
+
+	void command_buffer::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		this->draw_to(target, states);
+	}
+
+	void command_buffer::clear()
+	{
+		vertices.clear();
+		commands.clear();
+		blends.clear();
+		sorted.clear();
+		runs.clear();
+		compiled = true;
+	}
+
+	void command_buffer::reserve(size_t count)
+	{
+		vertices.reserve(count);
+	}
+
+	void command_buffer::add(const sf::Vertex* source, size_t count, sf::PrimitiveType type,
+	                         const sf::RenderStates& states, uint32_t layer)
+	{
+		auto& transform = states.transform;
+		auto vertex = [&] (size_t i) {
+			sf::Vertex v = source[i];
+			v.position = transform.transformPoint(v.position);
+			return v;
+		};
+
+		sf::Vertex* out = nullptr;
+		switch(type) {
+		case sf::Points:
+		case sf::Lines:
+		case sf::Triangles:
+			count -= type == sf::Lines ? count % 2 : type == sf::Triangles ? count % 3 : 0;
+			if(count == 0) {
+				return;
+			}
+			out = this->record(count, type, states.texture, states.blendMode, layer);
+			for(size_t i = 0; i < count; ++i) {
+				out[i] = vertex(i);
+			}
+			break;
+		case sf::LineStrip:
+			if(count < 2) {
+				return;
+			}
+			out = this->record((count - 1) * 2, sf::Lines, states.texture, states.blendMode, layer);
+			for(size_t i = 0; i + 1 < count; ++i) {
+				*out++ = vertex(i);
+				*out++ = vertex(i + 1);
+			}
+			break;
+		case sf::TriangleStrip:
+		case sf::TriangleFan:
+			if(count < 3) {
+				return;
+			}
+			out = this->record((count - 2) * 3, sf::Triangles, states.texture, states.blendMode, layer);
+			for(size_t i = 0; i + 2 < count; ++i) {
+				*out++ = vertex(type == sf::TriangleFan ? 0 : i);
+				*out++ = vertex(i + 1);
+				*out++ = vertex(i + 2);
+			}
+			break;
+		case sf::Quads:
+			if(count < 4) {
+				return;
+			}
+			out = this->record(count / 4 * 6, sf::Triangles, states.texture, states.blendMode, layer);
+			for(size_t i = 0; i + 3 < count; i += 4) {
+				*out++ = vertex(i);
+				*out++ = vertex(i + 1);
+				*out++ = vertex(i + 2);
+				*out++ = vertex(i);
+				*out++ = vertex(i + 2);
+				*out++ = vertex(i + 3);
+			}
+			break;
+		}
+	}
+
+	void command_buffer::add_rect(const sf::FloatRect& rect, const sf::Color& colour,
+	                              const sf::Transform& transform, uint32_t layer)
+	{
+		float right = rect.left + rect.width;
+		float bottom = rect.top + rect.height;
+		sf::Vertex quad[4] = {
+			sf::Vertex({rect.left, rect.top}, colour),
+			sf::Vertex({right, rect.top}, colour),
+			sf::Vertex({right, bottom}, colour),
+			sf::Vertex({rect.left, bottom}, colour),
+		};
+		this->add(quad, 4, sf::Quads, sf::RenderStates(transform), layer);
+	}
+
+	void command_buffer::add_rect(const sf::FloatRect& rect, const sf::Texture& texture, const sf::FloatRect& tex_rect,
+	                              const sf::Color& colour, const sf::Transform& transform, uint32_t layer)
+	{
+		float right = rect.left + rect.width;
+		float bottom = rect.top + rect.height;
+		float u1 = tex_rect.left + tex_rect.width;
+		float v1 = tex_rect.top + tex_rect.height;
+		sf::Vertex quad[4] = {
+			sf::Vertex({rect.left, rect.top}, colour, {tex_rect.left, tex_rect.top}),
+			sf::Vertex({right, rect.top}, colour, {u1, tex_rect.top}),
+			sf::Vertex({right, bottom}, colour, {u1, v1}),
+			sf::Vertex({rect.left, bottom}, colour, {tex_rect.left, v1}),
+		};
+		sf::RenderStates states(transform);
+		states.texture = &texture;
+		this->add(quad, 4, sf::Quads, states, layer);
+	}
+
+	void command_buffer::add_shape(const sf::Shape& shape, uint32_t layer)
+	{
+		unsigned int count = shape.getPointCount();
+		if(count < 3) {
+			return;
+		}
+
+		// texture coordinates map the shape's bounds to the texture rectangle, as sf::Shape does
+		std::vector<sf::Vertex> fan(count);
+		float min_x = shape.getPoint(0).x, max_x = min_x;
+		float min_y = shape.getPoint(0).y, max_y = min_y;
+		for(unsigned int i = 0; i < count; ++i) {
+			auto point = shape.getPoint(i);
+			fan[i] = sf::Vertex(point, shape.getFillColor());
+			min_x = std::min(min_x, point.x);
+			max_x = std::max(max_x, point.x);
+			min_y = std::min(min_y, point.y);
+			max_y = std::max(max_y, point.y);
+		}
+
+		sf::RenderStates states(shape.getTransform());
+		if(auto texture = shape.getTexture()) {
+			sf::FloatRect tex_rect(shape.getTextureRect());
+			float width = max_x > min_x ? max_x - min_x : 1;
+			float height = max_y > min_y ? max_y - min_y : 1;
+			for(auto& v : fan) {
+				v.texCoords.x = tex_rect.left + tex_rect.width * (v.position.x - min_x) / width;
+				v.texCoords.y = tex_rect.top + tex_rect.height * (v.position.y - min_y) / height;
+			}
+			states.texture = texture;
+		}
+		this->add(fan.data(), fan.size(), sf::TriangleFan, states, layer);
+	}
+
+	void command_buffer::append(const command_buffer& other)
+	{
+		for(auto& c : other.commands) {
+			auto out = this->record(c.count, c.type, c.texture, other.blends[c.blend], c.layer);
+			std::copy(&other.vertices[c.first], &other.vertices[c.first] + c.count, out);
+		}
+	}
+
+	void command_buffer::compile() const
+	{
+		if(compiled) {
+			return;
+		}
+
+		order.resize(commands.size());
+		for(size_t i = 0; i < order.size(); ++i) {
+			order[i] = uint32_t(i);
+		}
+		std::stable_sort(order.begin(), order.end(), [this] (uint32_t lhs, uint32_t rhs) {
+				auto& a = commands[lhs];
+				auto& b = commands[rhs];
+				if(a.layer != b.layer) {
+					return a.layer < b.layer;
+				}
+				if(a.texture != b.texture) {
+					return std::less<const sf::Texture*>()(a.texture, b.texture);
+				}
+				if(a.blend != b.blend) {
+					return a.blend < b.blend;
+				}
+				return a.type < b.type;
+			});
+
+		sorted.resize(vertices.size());
+		runs.clear();
+		size_t next = 0;
+		for(auto index : order) {
+			auto& c = commands[index];
+			if(runs.empty() || runs.back().texture != c.texture || runs.back().blend != c.blend
+			|| runs.back().type != c.type) {
+				runs.push_back(run{c.texture, c.blend, c.type, next, 0});
+			}
+			std::copy(&vertices[c.first], &vertices[c.first] + c.count, &sorted[next]);
+			runs.back().count += c.count;
+			next += c.count;
+		}
+
+		compiled = true;
+	}
+
+	size_t command_buffer::size() const
+	{
+		return commands.size();
+	}
+
+	bool command_buffer::empty() const
+	{
+		return commands.empty();
+	}
+
+	command_buffer::statistics command_buffer::get_stats() const
+	{
+		this->compile();
+		return statistics{commands.size(), runs.size()};
+	}
+
+	// }}}
+
+} // namespace disp
@@ -0,0 +1,158 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/drawable.hpp>
+#include <sfml/graphics/primitivetype.hpp>
+#include <sfml/graphics/rect.hpp>
+#include <sfml/graphics/renderstates.hpp>
+#include <sfml/graphics/shape.hpp>
+#include <sfml/graphics/texture.hpp>
+#include <sfml/graphics/transform.hpp>
+#include <sfml/graphics/vertex.hpp>
+
+/**
+ * \file
+ * \brief Recorded draw commands
+ *
+ * This provides disp::command_buffer, which records draws into memory so a
+ * frame can be built on one thread and drawn on another (see
+ * disp::render_thread).
+ */
+
+namespace disp {
+
+	/**
+	 * \class command_buffer
+	 * \brief Recorded draw calls, replayed sorted by state
+	 *
+	 * Draws are recorded with their layer, texture and blend mode. The
+	 * vertices are transformed when recorded, and strips, fans and quads
+	 * are turned into separate triangles, so commands with the same state
+	 * can be drawn together however they were recorded.
+	 *
+	 * When drawn, commands are stably sorted by layer, then by texture,
+	 * blend mode and primitive type, and each run with the same state is
+	 * drawn with one call. Layers are drawn in increasing order, but
+	 * within a layer commands with different textures may be reordered, so
+	 * anything which must be drawn over something else should go on a
+	 * higher layer.
+	 *
+	 * Recording does not touch OpenGL, so it can be done on any thread,
+	 * but a buffer is not shared between threads; record a buffer per
+	 * thread, and append() them together. Shaders are not recorded.
+	 */
+	class command_buffer
+		: public sf::Drawable
+	{
+	public: // statics
+
+		struct statistics
+		{
+			size_t commands; // recorded draws
+			size_t draw_calls; // draws after sorting
+		};
+
+	private: // statics
+
+		struct command
+		{
+			uint32_t layer;
+			uint32_t blend; // index into blends
+			const sf::Texture* texture;
+			sf::PrimitiveType type; // sf::Points, sf::Lines or sf::Triangles
+			size_t first; // index of the first vertex
+			size_t count; // number of vertices
+		};
+
+		// commands with the same state, drawn together
+		struct run
+		{
+			const sf::Texture* texture;
+			uint32_t blend;
+			sf::PrimitiveType type;
+			size_t first;
+			size_t count;
+		};
+
+	private: // variables
+
+		// as recorded
+		std::vector<sf::Vertex> vertices;
+		std::vector<command> commands;
+		std::vector<sf::BlendMode> blends;
+
+		// sorted, built when drawn
+		mutable std::vector<sf::Vertex> sorted;
+		mutable std::vector<run> runs;
+		mutable std::vector<uint32_t> order;
+		mutable bool compiled;
+
+	private: // internal methods
+
+		uint32_t blend_index(const sf::BlendMode& blend);
+
+		// starts a command if the state differs from the last one, and returns space for its vertices
+		sf::Vertex* record(size_t count, sf::PrimitiveType type, const sf::Texture* texture,
+		                   const sf::BlendMode& blend, uint32_t layer);
+
+	protected: // internal methods
+
+		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	public: // methods
+
+		command_buffer();
+
+		/// Remove all commands, keeping the storage
+		void clear();
+
+		/// Reserve storage for \p count vertices
+		void reserve(size_t count);
+
+		/// Record a draw, as sf::RenderTarget::draw
+		void add(const sf::Vertex* source, size_t count, sf::PrimitiveType type,
+		         const sf::RenderStates& states = sf::RenderStates::Default, uint32_t layer = 0);
+
+		/// Record a coloured rectangle
+		void add_rect(const sf::FloatRect& rect, const sf::Color& colour,
+		              const sf::Transform& transform = sf::Transform::Identity, uint32_t layer = 0);
+
+		/// Record a textured rectangle
+		void add_rect(const sf::FloatRect& rect, const sf::Texture& texture, const sf::FloatRect& tex_rect,
+		              const sf::Color& colour = sf::Color::White,
+		              const sf::Transform& transform = sf::Transform::Identity, uint32_t layer = 0);
+
+		/// Record the fill of a shape, without its outline
+		void add_shape(const sf::Shape& shape, uint32_t layer = 0);
+
+		/// Record the commands of another buffer, e.g. one recorded on another thread
+		void append(const command_buffer& other);
+
+		/// Sort the commands, if not done since the last change
+		void compile() const;
+
+		/// Draw to any target with sf::RenderTarget's vertex draw, e.g. soft_target
+		template <typename Target>
+		void draw_to(Target& target, sf::RenderStates states) const
+		{
+			this->compile();
+			for(auto& r : runs) {
+				states.texture = r.texture;
+				states.blendMode = blends[r.blend];
+				target.draw(&sorted[r.first], r.count, r.type, states);
+			}
+		}
+
+		/// Number of recorded commands
+		size_t size() const;
+		bool empty() const;
+
+		statistics get_stats() const;
+
+	};
+
+} // namespace disp
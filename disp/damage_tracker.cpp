@@ -0,0 +1,163 @@
+#include "damage_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <sfml/graphics/rectangleshape.hpp>
+#include <sfml/graphics/sprite.hpp>
+
+namespace { // anonymous
+
+	// true if the rectangles overlap or share an edge
+	bool touches(const sf::IntRect& a, const sf::IntRect& b)
+	{
+		return a.left <= b.left + b.width && b.left <= a.left + a.width
+		    && a.top <= b.top + b.height && b.top <= a.top + a.height;
+	}
+
+	sf::IntRect merge(const sf::IntRect& a, const sf::IntRect& b)
+	{
+		int left = std::min(a.left, b.left);
+		int top = std::min(a.top, b.top);
+		int right = std::max(a.left + a.width, b.left + b.width);
+		int bottom = std::max(a.top + a.height, b.top + b.height);
+		return sf::IntRect(left, top, right - left, bottom - top);
+	}
+
+} // namespace anonymous
+
+namespace disp {
+
+	// class damage_tracker {{{
+
+	damage_tracker::damage_tracker()
+		: canvas(), background(sf::Color::Black), rects()
+		, last_rects(0), last_area(0), frames(0), total_area(0)
+	{
+	}
+
+	void damage_tracker::begin_rect(const sf::IntRect& rect)
+	{
+		// the viewport clips drawing, but clear() would fill the whole canvas
+		auto size = sf::Vector2f(canvas.getSize());
+		sf::FloatRect area(rect);
+		sf::View view(area);
+		view.setViewport(sf::FloatRect(rect.left / size.x, rect.top / size.y,
+		                               rect.width / size.x, rect.height / size.y));
+		canvas.setView(view);
+
+		sf::RectangleShape fill(sf::Vector2f(float(rect.width), float(rect.height)));
+		fill.setPosition(float(rect.left), float(rect.top));
+		fill.setFillColor(background);
+		canvas.draw(fill, sf::BlendNone);
+	}
+
+	void damage_tracker::end_frame()
+	{
+		canvas.setView(canvas.getDefaultView());
+		canvas.display();
+
+		last_rects = rects.size();
+		last_area = 0;
+		for(auto& rect : rects) {
+			last_area += uint64_t(rect.width) * rect.height;
+		}
+		++frames;
+		total_area += last_area;
+		rects.clear();
+	}
+
+	bool damage_tracker::create(unsigned int width, unsigned int height)
+	{
+		if(!canvas.create(width, height)) {
+			return false;
+		}
+		this->damage_all();
+		return true;
+	}
+
+	void damage_tracker::set_background(const sf::Color& new_background)
+	{
+		if(background != new_background) {
+			background = new_background;
+			this->damage_all();
+		}
+	}
+
+	const sf::Color& damage_tracker::get_background() const
+	{
+		return background;
+	}
+
+	void damage_tracker::damage(const sf::FloatRect& bounds)
+	{
+		// cover every pixel the bounds touch, within the canvas
+		auto size = canvas.getSize();
+		int left = std::max(0, int(std::floor(bounds.left)));
+		int top = std::max(0, int(std::floor(bounds.top)));
+		int right = std::min(int(size.x), int(std::ceil(bounds.left + bounds.width)));
+		int bottom = std::min(int(size.y), int(std::ceil(bounds.top + bounds.height)));
+		if(right <= left || bottom <= top) {
+			return;
+		}
+
+		// merge with whatever it touches, until nothing else does
+		sf::IntRect rect(left, top, right - left, bottom - top);
+		for(auto it = rects.begin(); it != rects.end(); ) {
+			if(touches(*it, rect)) {
+				rect = merge(*it, rect);
+				rects.erase(it);
+				it = rects.begin();
+			} else {
+				++it;
+			}
+		}
+		rects.push_back(rect);
+
+		if(rects.size() > max_rects) {
+			for(size_t i = 1; i < rects.size(); ++i) {
+				rects[0] = merge(rects[0], rects[i]);
+			}
+			rects.resize(1);
+		}
+	}
+
+	void damage_tracker::damage_all()
+	{
+		auto size = canvas.getSize();
+		rects.clear();
+		if(size.x > 0 && size.y > 0) {
+			rects.push_back(sf::IntRect(0, 0, int(size.x), int(size.y)));
+		}
+	}
+
+	bool damage_tracker::has_damage() const
+	{
+		return !rects.empty();
+	}
+
+	const std::vector<sf::IntRect>& damage_tracker::get_damage() const
+	{
+		return rects;
+	}
+
+	void damage_tracker::present(sf::RenderTarget& target) const
+	{
+		sf::Sprite sprite(canvas.getTexture());
+		target.draw(sprite, sf::BlendNone);
+	}
+
+	const sf::Texture& damage_tracker::get_texture() const
+	{
+		return canvas.getTexture();
+	}
+
+	damage_tracker::statistics damage_tracker::get_stats() const
+	{
+		auto size = canvas.getSize();
+		return statistics{last_rects, last_area, frames, total_area, uint64_t(size.x) * size.y};
+	}
+
+	// }}}
+
+} // namespace disp
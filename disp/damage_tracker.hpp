@@ -0,0 +1,129 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/rect.hpp>
+#include <sfml/graphics/rendertexture.hpp>
+
+/**
+ * \file
+ * \brief Redrawing only what changed
+ *
+ * This provides disp::damage_tracker, which keeps the last frame in a render
+ * texture, so only the regions which changed are redrawn each frame instead
+ * of clearing and redrawing the whole window.
+ */
+
+namespace disp {
+
+	/**
+	 * \class damage_tracker
+	 * \brief Persistent canvas with dirty rectangles
+	 *
+	 * Each frame, the bounds of everything that changed are given to
+	 * damage(), both where it was and where it is now. redraw() then calls
+	 * the scene's draw function once per damaged rectangle, with drawing
+	 * clipped to that rectangle, which has been filled with the background.
+	 * The draw function is given the rectangle, so it can skip anything
+	 * outside it. Everything else on the canvas is kept from the previous
+	 * frame. present() draws the canvas to the window.
+	 *
+	 * Overlapping or touching rectangles are merged, and if there are more
+	 * than max_rects they are merged into their bounding box, so a frame
+	 * where much has changed costs at most a full redraw.
+	 *
+	 * Coordinates are in pixels of the canvas, and the scene is drawn with
+	 * the canvas' default view.
+	 */
+	class damage_tracker
+	{
+	public: // statics
+
+		/// Rectangles kept before merging to the bounding box
+		static constexpr size_t max_rects = 8;
+
+		struct statistics
+		{
+			size_t rects; // rectangles redrawn in the last frame
+			uint64_t area; // pixels redrawn in the last frame
+			uint64_t frames; // frames redrawn
+			uint64_t total_area; // pixels redrawn in all frames
+			uint64_t canvas_area; // pixels in the canvas
+		};
+
+	private: // variables
+
+		sf::RenderTexture canvas;
+		sf::Color background;
+		std::vector<sf::IntRect> rects;
+
+		size_t last_rects;
+		uint64_t last_area;
+		uint64_t frames;
+		uint64_t total_area;
+
+	private: // internal methods
+
+		// clips drawing on the canvas to the rectangle, and fills it with the background
+		void begin_rect(const sf::IntRect& rect);
+		void end_frame();
+
+	public: // methods
+
+		damage_tracker();
+
+		damage_tracker(const damage_tracker&) = delete;
+		damage_tracker& operator=(const damage_tracker&) = delete;
+
+		/// Create the canvas, e.g. at the window size, damaging all of it
+		bool create(unsigned int width, unsigned int height);
+
+		void set_background(const sf::Color& new_background);
+		const sf::Color& get_background() const;
+
+		/// Mark a region as changed
+		void damage(const sf::FloatRect& bounds);
+
+		/// Mark the whole canvas as changed
+		void damage_all();
+
+		/// Find if anything needs redrawing
+		bool has_damage() const;
+
+		/// Damaged rectangles, after merging
+		const std::vector<sf::IntRect>& get_damage() const;
+
+		/**
+		 * \fn redraw
+		 * \brief Redraw the damaged rectangles
+		 *
+		 * Calls \p draw_scene(target, rect) for each damaged rectangle,
+		 * then clears the damage. Returns false if nothing was damaged.
+		 */
+		template <typename Func>
+		bool redraw(Func&& draw_scene)
+		{
+			if(rects.empty()) {
+				return false;
+			}
+			for(auto& rect : rects) {
+				this->begin_rect(rect);
+				draw_scene(static_cast<sf::RenderTarget&>(canvas), sf::FloatRect(rect));
+			}
+			this->end_frame();
+			return true;
+		}
+
+		/// Draw the canvas to the target, e.g. the window
+		void present(sf::RenderTarget& target) const;
+
+		const sf::Texture& get_texture() const;
+
+		statistics get_stats() const;
+
+	};
+
+} // namespace disp
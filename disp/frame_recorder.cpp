@@ -0,0 +1,430 @@
+#include "frame_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <sfml/opengl.hpp>
+
+namespace { // anonymous
+
+	const char magic[4] = {'R', 'C', 'A', 'P'};
+	const uint32_t version = 1;
+
+	enum encoding_type : uint8_t
+	{
+		encoding_raw = 0,
+		encoding_delta = 1
+	};
+
+	// shorter runs of unchanged bytes are kept in the literal, as a new run costs 8 bytes
+	const size_t min_zero_run = 8;
+
+	const size_t frame_header_size = 4 + 4 + 8 + 1 + 8;
+
+	void put_u32(uint8_t* out, uint32_t value)
+	{
+		for(int i = 0; i < 4; ++i) {
+			out[i] = uint8_t(value >> (8 * i));
+		}
+	}
+
+	void put_u64(uint8_t* out, uint64_t value)
+	{
+		for(int i = 0; i < 8; ++i) {
+			out[i] = uint8_t(value >> (8 * i));
+		}
+	}
+
+	uint32_t get_u32(const uint8_t* in)
+	{
+		uint32_t value = 0;
+		for(int i = 3; i >= 0; --i) {
+			value = (value << 8) | in[i];
+		}
+		return value;
+	}
+
+	uint64_t get_u64(const uint8_t* in)
+	{
+		uint64_t value = 0;
+		for(int i = 7; i >= 0; --i) {
+			value = (value << 8) | in[i];
+		}
+		return value;
+	}
+
+} // namespace anonymous
+
+namespace disp {
+
+	// class frame_recorder {{{
+
+	frame_recorder::frame_recorder()
+		: file(), format(format_delta)
+		, frames(), free_frames(), queued()
+		, writer(), lock(), cond(), stopping(false), write_failed(false)
+		, previous(), previous_width(0), previous_height(0), since_keyframe(0), encoded()
+		, frame_number(0), stats{0, 0, 0, 0, 0}
+	{
+	}
+
+	frame_recorder::~frame_recorder()
+	{
+		this->close();
+	}
+
+	bool frame_recorder::acquire(size_t& index)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		uint64_t number = frame_number++;
+		if(write_failed) {
+			++stats.failed;
+			return false;
+		}
+		if(free_frames.empty()) {
+			++stats.dropped;
+			return false;
+		}
+		index = free_frames.back();
+		free_frames.pop_back();
+		frames[index].number = number;
+		return true;
+	}
+
+	void frame_recorder::enqueue(size_t index, unsigned int width, unsigned int height)
+	{
+		frames[index].width = width;
+		frames[index].height = height;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			queued.push_back(index);
+			++stats.captured;
+		}
+		cond.notify_all();
+	}
+
+	void frame_recorder::run()
+	{
+		while(true) {
+			size_t index;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				cond.wait(guard, [this] { return !queued.empty() || stopping; });
+				if(queued.empty()) {
+					break;
+				}
+				index = queued.front();
+				queued.pop_front();
+			}
+
+			uint64_t bytes = this->write(frames[index]);
+
+			std::lock_guard<std::mutex> guard(lock);
+			free_frames.push_back(index);
+			if(bytes == 0) {
+				// the rest of the file would be unreadable, so give up on it
+				write_failed = true;
+				stats.failed += 1 + queued.size();
+				free_frames.insert(free_frames.end(), queued.begin(), queued.end());
+				queued.clear();
+				break;
+			}
+			++stats.written;
+			stats.bytes += bytes;
+		}
+	}
+
+	uint64_t frame_recorder::write(frame& f)
+	{
+		if(f.bottom_up) {
+			// as read from OpenGL, so flip it here rather than on the frame loop
+			size_t row = size_t(f.width) * 4;
+			for(unsigned int y = 0; y < f.height / 2; ++y) {
+				std::swap_ranges(&f.pixels[y * row], &f.pixels[(y + 1) * row], &f.pixels[(f.height - 1 - y) * row]);
+			}
+		}
+
+		bool delta = format == format_delta && since_keyframe < keyframe_interval
+		          && f.width == previous_width && f.height == previous_height;
+
+		const uint8_t* payload = f.pixels.data();
+		size_t payload_size = f.pixels.size();
+		if(delta) {
+			const uint8_t* cur = f.pixels.data();
+			const uint8_t* prev = previous.data();
+			size_t n = f.pixels.size();
+
+			encoded.clear();
+			for(size_t i = 0; i < n; ) {
+				size_t skip_start = i;
+				while(i < n && cur[i] == prev[i]) {
+					++i;
+				}
+
+				// literal bytes, until a long enough run of unchanged bytes
+				size_t literal_start = i;
+				while(i < n) {
+					if(cur[i] != prev[i]) {
+						++i;
+						continue;
+					}
+					size_t run_end = i;
+					while(run_end < n && run_end - i < min_zero_run && cur[run_end] == prev[run_end]) {
+						++run_end;
+					}
+					if(run_end - i >= min_zero_run || run_end == n) {
+						break;
+					}
+					i = run_end;
+				}
+
+				size_t offset = encoded.size();
+				encoded.resize(offset + 8 + (i - literal_start));
+				put_u32(&encoded[offset], uint32_t(literal_start - skip_start));
+				put_u32(&encoded[offset + 4], uint32_t(i - literal_start));
+				for(size_t k = literal_start; k < i; ++k) {
+					encoded[offset + 8 + (k - literal_start)] = cur[k] ^ prev[k];
+				}
+			}
+
+			payload = encoded.data();
+			payload_size = encoded.size();
+			++since_keyframe;
+		} else {
+			since_keyframe = 0;
+		}
+
+		uint8_t header[frame_header_size];
+		put_u32(header, f.width);
+		put_u32(header + 4, f.height);
+		put_u64(header + 8, f.number);
+		header[16] = delta ? encoding_delta : encoding_raw;
+		put_u64(header + 17, payload_size);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(payload), std::streamsize(payload_size));
+		if(!file) {
+			return 0;
+		}
+
+		// the next delta is against this frame, and the buffer gets the old storage
+		std::swap(previous, f.pixels);
+		previous_width = f.width;
+		previous_height = f.height;
+
+		return sizeof(header) + payload_size;
+	}
+
+	bool frame_recorder::open(const std::string& filename, format_type new_format, size_t buffers)
+	{
+		this->close();
+
+		file.open(filename, std::ios::binary | std::ios::trunc);
+		if(!file) {
+			return false;
+		}
+		uint8_t header[8];
+		std::memcpy(header, magic, 4);
+		put_u32(header + 4, version);
+		if(!file.write(reinterpret_cast<const char*>(header), sizeof(header))) {
+			file.close();
+			return false;
+		}
+
+		format = new_format;
+		frames.assign(std::max<size_t>(1, buffers), frame{});
+		free_frames.clear();
+		for(size_t i = 0; i < frames.size(); ++i) {
+			free_frames.push_back(i);
+		}
+		queued.clear();
+		stopping = false;
+		write_failed = false;
+
+		previous.clear();
+		previous_width = 0;
+		previous_height = 0;
+		since_keyframe = 0;
+		frame_number = 0;
+		stats = statistics{0, 0, 0, 0, 0};
+
+		writer = std::thread(&frame_recorder::run, this);
+		return true;
+	}
+
+	void frame_recorder::close()
+	{
+		if(!writer.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		cond.notify_all();
+		writer.join();
+		file.close();
+	}
+
+	bool frame_recorder::is_open() const
+	{
+		return writer.joinable();
+	}
+
+	bool frame_recorder::push(const uint8_t* pixels, unsigned int width, unsigned int height)
+	{
+		size_t index;
+		if(!this->is_open() || !this->acquire(index)) {
+			return false;
+		}
+		frames[index].pixels.assign(pixels, pixels + size_t(width) * height * 4);
+		frames[index].bottom_up = false;
+		this->enqueue(index, width, height);
+		return true;
+	}
+
+	bool frame_recorder::push(sf::RenderWindow& window)
+	{
+		// take a buffer first, so a dropped frame is not read back
+		size_t index;
+		if(!this->is_open() || !this->acquire(index)) {
+			return false;
+		}
+
+		// read the back buffer straight into the pooled buffer, which keeps its storage
+		auto size = window.getSize();
+		auto& pixels = frames[index].pixels;
+		pixels.resize(size_t(size.x) * size.y * 4);
+		if(!window.setActive(true)) {
+			std::lock_guard<std::mutex> guard(lock);
+			free_frames.push_back(index);
+			return false;
+		}
+		glReadPixels(0, 0, GLsizei(size.x), GLsizei(size.y), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		frames[index].bottom_up = true;
+
+		this->enqueue(index, size.x, size.y);
+		return true;
+	}
+
+	bool frame_recorder::push(soft_target& target)
+	{
+		target.display();
+		auto size = target.getSize();
+		return this->push(target.get_pixels(), size.x, size.y);
+	}
+
+	frame_recorder::statistics frame_recorder::get_stats() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return stats;
+	}
+
+	// }}}
+
+	// class frame_reader {{{
+
+	frame_reader::frame_reader()
+		: file(), file_size(0), pixels(), data(), width(0), height(0), number(0)
+	{
+	}
+
+	bool frame_reader::open(const std::string& filename)
+	{
+		file.close();
+		file.clear();
+		file.open(filename, std::ios::binary | std::ios::ate);
+		file_size = file ? uint64_t(file.tellg()) : 0;
+		file.seekg(0);
+
+		uint8_t header[8];
+		if(!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+			return false;
+		}
+		pixels.clear();
+		width = 0;
+		height = 0;
+		return std::memcmp(header, magic, 4) == 0 && get_u32(header + 4) == version;
+	}
+
+	bool frame_reader::next()
+	{
+		uint8_t header[frame_header_size];
+		if(!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+			return false;
+		}
+		unsigned int new_width = get_u32(header);
+		unsigned int new_height = get_u32(header + 4);
+		uint64_t size = get_u64(header + 17);
+		uint64_t frame_size = uint64_t(new_width) * new_height * 4;
+
+		// a corrupt or truncated file must not cause a huge allocation
+		if(size > file_size - uint64_t(file.tellg())) {
+			return false;
+		}
+
+		if(header[16] == encoding_raw) {
+			if(size != frame_size) {
+				return false;
+			}
+			pixels.resize(frame_size);
+			if(!file.read(reinterpret_cast<char*>(pixels.data()), std::streamsize(size))) {
+				return false;
+			}
+		} else if(header[16] == encoding_delta) {
+			// at most one run for each byte, and one more
+			if(new_width != width || new_height != height || pixels.size() != frame_size
+			   || size > frame_size + 8 * (frame_size + 1)) {
+				return false;
+			}
+			data.resize(size);
+			if(!file.read(reinterpret_cast<char*>(data.data()), std::streamsize(size))) {
+				return false;
+			}
+
+			size_t pos = 0;
+			for(size_t i = 0; i + 8 <= data.size(); ) {
+				size_t skip = get_u32(&data[i]);
+				size_t literal = get_u32(&data[i + 4]);
+				i += 8;
+				if(pos + skip + literal > pixels.size() || i + literal > data.size()) {
+					return false;
+				}
+				pos += skip;
+				for(size_t k = 0; k < literal; ++k) {
+					pixels[pos++] ^= data[i++];
+				}
+			}
+		} else {
+			return false;
+		}
+
+		width = new_width;
+		height = new_height;
+		number = get_u64(header + 8);
+		return true;
+	}
+
+	const std::vector<uint8_t>& frame_reader::get_pixels() const
+	{
+		return pixels;
+	}
+
+	unsigned int frame_reader::get_width() const
+	{
+		return width;
+	}
+
+	unsigned int frame_reader::get_height() const
+	{
+		return height;
+	}
+
+	uint64_t frame_reader::get_number() const
+	{
+		return number;
+	}
+
+	// }}}
+
+} // namespace disp
@@ -0,0 +1,182 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sfml/graphics/renderwindow.hpp>
+
+#include "soft_target.hpp"
+
+/**
+ * \file
+ * \brief Recording frames to disk
+ *
+ * This provides disp::frame_recorder, which saves frames to a file from a
+ * background thread, and disp::frame_reader to read them back.
+ *
+ * The file starts with "RCAP" and a 32 bit version. Each frame then has its
+ * width and height (32 bit), frame number (64 bit), encoding (8 bit) and
+ * size of its data (64 bit), all little endian. Raw frames are RGBA pixels.
+ * Delta frames are the pixels XORed with the previous frame, as runs of a
+ * 32 bit count of zero bytes, a 32 bit count of literal bytes, and the
+ * literal bytes.
+ */
+
+namespace disp {
+
+	/**
+	 * \class frame_recorder
+	 * \brief Background frame writer with a fixed pool of buffers
+	 *
+	 * push() copies a frame into a free buffer from the pool, and queues it
+	 * for the writer thread, which encodes and writes it. If the writer
+	 * has fallen behind and every buffer is queued, the frame is dropped
+	 * and counted, instead of stalling the frame loop. Frame numbers count
+	 * dropped frames too, so they show up as gaps in the file.
+	 *
+	 * If a write fails (e.g. the disk is full), the writer stops, and the
+	 * frame and any after it are counted as failed instead of written.
+	 *
+	 * Windows are read back with glReadPixels straight into a buffer from
+	 * the pool, which still waits for the GPU to finish the frame; the row
+	 * flip, encoding and writing are what is moved off the frame loop.
+	 * soft_target frames are copied directly.
+	 */
+	class frame_recorder
+	{
+	public: // statics
+
+		enum format_type
+		{
+			format_raw,
+			format_delta
+		};
+
+		struct statistics
+		{
+			uint64_t captured; // frames queued
+			uint64_t dropped; // frames dropped with no free buffer
+			uint64_t written; // frames written
+			uint64_t bytes; // bytes written
+			uint64_t failed; // frames lost to a write error
+		};
+
+		/// Frames between raw frames when writing deltas, so files can be cut
+		static constexpr uint64_t keyframe_interval = 300;
+
+	private: // statics
+
+		struct frame
+		{
+			std::vector<uint8_t> pixels;
+			unsigned int width;
+			unsigned int height;
+			uint64_t number;
+			bool bottom_up; // rows from the bottom, as read from OpenGL
+		};
+
+	private: // variables
+
+		std::ofstream file;
+		format_type format;
+
+		std::vector<frame> frames;
+		std::vector<size_t> free_frames;
+		std::deque<size_t> queued;
+
+		std::thread writer;
+		mutable std::mutex lock;
+		std::condition_variable cond;
+		bool stopping;
+		bool write_failed;
+
+		// only used by the writer thread
+		std::vector<uint8_t> previous;
+		unsigned int previous_width;
+		unsigned int previous_height;
+		uint64_t since_keyframe;
+		std::vector<uint8_t> encoded;
+
+		uint64_t frame_number;
+		statistics stats;
+
+	private: // internal methods
+
+		// takes a free buffer, or returns false and counts a dropped frame
+		bool acquire(size_t& index);
+		void enqueue(size_t index, unsigned int width, unsigned int height);
+
+		void run();
+		// encodes and writes a frame, returning the bytes written, or 0 on an error
+		uint64_t write(frame& f);
+
+	public: // methods
+
+		frame_recorder();
+		~frame_recorder();
+
+		frame_recorder(const frame_recorder&) = delete;
+		frame_recorder& operator=(const frame_recorder&) = delete;
+
+		/// Start recording to a file, with \p buffers frames allowed to be queued
+		bool open(const std::string& filename, format_type new_format = format_delta, size_t buffers = 4);
+
+		/// Write any queued frames, and close the file
+		void close();
+
+		bool is_open() const;
+
+		/// Queue RGBA pixels, returning false if the frame was dropped
+		bool push(const uint8_t* pixels, unsigned int width, unsigned int height);
+
+		/// Queue the window contents. Call before display()
+		bool push(sf::RenderWindow& window);
+
+		/// Queue the framebuffer, rasterising pending draws
+		bool push(soft_target& target);
+
+		statistics get_stats() const;
+
+	};
+
+	/**
+	 * \class frame_reader
+	 * \brief Reads frames written by frame_recorder
+	 */
+	class frame_reader
+	{
+	private: // variables
+
+		std::ifstream file;
+		uint64_t file_size;
+		std::vector<uint8_t> pixels;
+		std::vector<uint8_t> data;
+		unsigned int width;
+		unsigned int height;
+		uint64_t number;
+
+	public: // methods
+
+		frame_reader();
+
+		bool open(const std::string& filename);
+
+		/// Read the next frame, returning false at the end or on an error
+		bool next();
+
+		/// RGBA pixels of the current frame
+		const std::vector<uint8_t>& get_pixels() const;
+		unsigned int get_width() const;
+		unsigned int get_height() const;
+		uint64_t get_number() const;
+
+	};
+
+} // namespace disp
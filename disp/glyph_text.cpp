@@ -0,0 +1,165 @@
+#include "glyph_text.hpp"
+
+#include <algorithm>
+
+#include <sfml/graphics/rendertarget.hpp>
+
+namespace disp {
+
+	// class glyph_text {{{
+
+	glyph_text::glyph_text()
+		: glyphs(nullptr), atlas(nullptr), atlas_image(nullptr), str(), colour(sf::Color::White)
+		, vertices(sf::Quads), bounds()
+	{
+	}
+
+	glyph_text::glyph_text(const res::glyph_set& init_glyphs, const sf::Texture& init_atlas)
+		: glyph_text()
+	{
+		this->set_glyphs(init_glyphs, init_atlas);
+	}
+
+	void glyph_text::rebuild()
+	{
+		vertices.clear();
+		bounds = sf::FloatRect();
+		if(!glyphs) {
+			return;
+		}
+
+		// same layout as sf::Text - the first baseline is one character size down
+		float x = 0;
+		float y = float(glyphs->size);
+
+		float min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+		bool empty = true;
+
+		for(unsigned char c : str) {
+			if(c == '\n') {
+				x = 0;
+				y += glyphs->line_spacing;
+				continue;
+			}
+
+			auto g = glyphs->find(c);
+			if(!g) {
+				continue;
+			}
+
+			if(g->width > 0 && g->height > 0) {
+				float left = x + g->left;
+				float top = y + g->top;
+				float right = left + g->width;
+				float bottom = top + g->height;
+
+				float u0 = g->rect.left;
+				float v0 = g->rect.top;
+				float u1 = u0 + g->rect.width;
+				float v1 = v0 + g->rect.height;
+
+				vertices.append(sf::Vertex({left, top}, colour, {u0, v0}));
+				vertices.append(sf::Vertex({right, top}, colour, {u1, v0}));
+				vertices.append(sf::Vertex({right, bottom}, colour, {u1, v1}));
+				vertices.append(sf::Vertex({left, bottom}, colour, {u0, v1}));
+
+				if(empty) {
+					min_x = left, min_y = top, max_x = right, max_y = bottom;
+					empty = false;
+				} else {
+					min_x = std::min(min_x, left);
+					min_y = std::min(min_y, top);
+					max_x = std::max(max_x, right);
+					max_y = std::max(max_y, bottom);
+				}
+			}
+
+			x += g->advance;
+		}
+
+		bounds = sf::FloatRect(min_x, min_y, max_x - min_x, max_y - min_y);
+	}
+
+	void glyph_text::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		this->draw_to(target, states);
+	}
+
+	void glyph_text::draw_to(soft_target& target, sf::RenderStates states) const
+	{
+		if(!atlas_image) {
+			this->draw_to<soft_target>(target, states);
+			return;
+		}
+		if(vertices.getVertexCount() == 0) {
+			return;
+		}
+		states.transform *= this->getTransform();
+		states.texture = nullptr;
+		target.draw(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), *atlas_image, states);
+	}
+
+	void glyph_text::set_glyphs(const res::glyph_set& new_glyphs, const sf::Texture& new_atlas)
+	{
+		glyphs = &new_glyphs;
+		atlas = &new_atlas;
+		this->rebuild();
+	}
+
+	void glyph_text::set_glyphs(const res::glyph_set& new_glyphs, const sf::Image& new_atlas_image)
+	{
+		glyphs = &new_glyphs;
+		atlas_image = &new_atlas_image;
+		this->rebuild();
+	}
+
+	void glyph_text::set_string(const std::string& new_str)
+	{
+		if(str == new_str) {
+			return;
+		}
+		str = new_str;
+		this->rebuild();
+	}
+
+	const std::string& glyph_text::get_string() const
+	{
+		return str;
+	}
+
+	void glyph_text::set_colour(const sf::Color& new_colour)
+	{
+		colour = new_colour;
+		for(size_t i = 0; i < vertices.getVertexCount(); ++i) {
+			vertices[i].color = colour;
+		}
+	}
+
+	const sf::Color& glyph_text::get_colour() const
+	{
+		return colour;
+	}
+
+	sf::FloatRect glyph_text::local_bounds() const
+	{
+		return bounds;
+	}
+
+	float glyph_text::line_spacing() const
+	{
+		return glyphs ? glyphs->line_spacing : 0;
+	}
+
+	const sf::VertexArray& glyph_text::get_vertices() const
+	{
+		return vertices;
+	}
+
+	const sf::Texture* glyph_text::get_texture() const
+	{
+		return atlas;
+	}
+
+	// }}}
+
+} // namespace disp
@@ -0,0 +1,108 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <string>
+
+#include <sfml/graphics/drawable.hpp>
+#include <sfml/graphics/image.hpp>
+#include <sfml/graphics/rect.hpp>
+#include <sfml/graphics/texture.hpp>
+#include <sfml/graphics/transformable.hpp>
+#include <sfml/graphics/vertexarray.hpp>
+
+#include "res/glyphs.hpp"
+#include "soft_target.hpp"
+
+/**
+ * \file
+ * \brief Text drawn from prebaked glyphs
+ *
+ * This provides disp::glyph_text, a lightweight replacement for sf::Text which
+ * uses a glyph atlas generated by cvt-glyphs instead of a font.
+ */
+
+namespace disp {
+
+	/**
+	 * \class glyph_text
+	 * \brief Text drawn from a prebaked glyph atlas
+	 *
+	 * This is similar to sf::Text, but the glyph metrics and bitmaps are
+	 * generated at build time. The vertices are only rebuilt when the
+	 * string changes, and the whole text is drawn with a single vertex
+	 * array. Characters which were not baked are skipped.
+	 *
+	 * The glyph set and texture are not owned, and must outlive the text.
+	 *
+	 * For a soft_target, the atlas can be given as an image instead, which
+	 * needs no GPU, e.g. when rendering headless.
+	 */
+	class glyph_text
+		: public sf::Drawable, public sf::Transformable
+	{
+	private: // variables
+
+		const res::glyph_set* glyphs;
+		const sf::Texture* atlas;
+		const sf::Image* atlas_image;
+
+		std::string str;
+		sf::Color colour;
+
+		sf::VertexArray vertices;
+		sf::FloatRect bounds;
+
+	private: // internal methods
+
+		void rebuild();
+
+	protected: // internal methods
+
+		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	public: // methods
+
+		glyph_text();
+		glyph_text(const res::glyph_set& init_glyphs, const sf::Texture& init_atlas);
+
+		/// Draw to any target with sf::RenderTarget's vertex draw, e.g. soft_target
+		template <typename Target>
+		void draw_to(Target& target, sf::RenderStates states) const
+		{
+			// the atlas may still be loading
+			if(!atlas || atlas->getSize().x == 0 || vertices.getVertexCount() == 0) {
+				return;
+			}
+			states.transform *= this->getTransform();
+			states.texture = atlas;
+			target.draw(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), states);
+		}
+
+		/// Draw to a soft_target, from the atlas image if there is one
+		void draw_to(soft_target& target, sf::RenderStates states) const;
+
+		/// Set the glyphs used, and the texture of the atlas page they are on
+		void set_glyphs(const res::glyph_set& new_glyphs, const sf::Texture& new_atlas);
+
+		/// Set the glyphs used, and the image of the atlas page, for drawing to a soft_target
+		void set_glyphs(const res::glyph_set& new_glyphs, const sf::Image& new_atlas_image);
+
+		void set_string(const std::string& new_str);
+		const std::string& get_string() const;
+
+		void set_colour(const sf::Color& new_colour);
+		const sf::Color& get_colour() const;
+
+		/// Bounding rectangle, not including the transform
+		sf::FloatRect local_bounds() const;
+
+		/// Line spacing of the glyph set
+		float line_spacing() const;
+
+		/// Vertices of the text, in local coordinates
+		const sf::VertexArray& get_vertices() const;
+		const sf::Texture* get_texture() const;
+
+	};
+
+} // namespace disp
@@ -6,7 +6,7 @@
 namespace sf {
 
 	LineShape::LineShape(const Vector2f& p0, const Vector2f& p1)
-		: direction(p1 - p0)
+		: direction(p1 - p0), thickness(0), offset()
 	{
 		this->setPosition(p0);
 		this->setThickness(1.0f);
@@ -17,6 +17,8 @@ namespace sf {
 	void LineShape::setThickness(float width)
 	{
 		thickness = width;
+		// computed once here, instead of for each point in update()
+		offset = getOffset(direction, thickness);
 		this->update();
 	}
 
@@ -30,6 +32,16 @@ namespace sf {
 		return std::sqrt(direction.x * direction.x + direction.y * direction.y);
 	}
 
+	Vector2f LineShape::getOffset(const Vector2f& direction, float thickness)
+	{
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+		if(length == 0) {
+			return {0, 0};
+		}
+		float scale = thickness / (2 * length);
+		return {-direction.y * scale, direction.x * scale};
+	}
+
 	unsigned int LineShape::getPointCount() const
 	{
 		return 4;
@@ -37,11 +49,6 @@ namespace sf {
 
 	Vector2f LineShape::getPoint(unsigned int index) const
 	{
-		Vector2f unitDirection = direction / this->getLength();
-		Vector2f unitPerpendicular = {-unitDirection.y, unitDirection.x};
-
-		Vector2f offset = (thickness / 2) * unitPerpendicular;
-
 		switch (index) {
 		case 0:
 			return offset;
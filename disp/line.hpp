@@ -30,6 +30,7 @@ namespace sf {
 
 		Vector2f direction;
 		float thickness;
+		Vector2f offset; // half the thickness, perpendicular to the direction
 
 	public: // methods
 
@@ -46,6 +47,9 @@ namespace sf {
 		/// Get the length of the line
 		float getLength() const;
 
+		/// Offset of the edges from the centre line, for \p thickness
+		static Vector2f getOffset(const Vector2f& direction, float thickness);
+
 		virtual unsigned int getPointCount() const override;
 		virtual Vector2f getPoint(unsigned int index) const override;
 	};
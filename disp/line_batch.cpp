@@ -0,0 +1,137 @@
+#include "line_batch.hpp"
+
+#include <cmath>
+
+#include <sfml/graphics/rendertarget.hpp>
+
+namespace disp {
+
+	// class line_batch {{{
+
+	line_batch::line_batch()
+		: x0(), y0(), x1(), y1(), thickness(), colours()
+		, offset_x(), offset_y(), vertices(), dirty(false)
+	{
+	}
+
+	void line_batch::rebuild() const
+	{
+		const size_t count = x0.size();
+		offset_x.resize(count);
+		offset_y.resize(count);
+
+		// offsets of the edges, as in sf::LineShape::getOffset
+		// this is kept branch-free so it can be vectorised
+		const float* ax = x0.data();
+		const float* ay = y0.data();
+		const float* bx = x1.data();
+		const float* by = y1.data();
+		const float* width = thickness.data();
+		float* ox = offset_x.data();
+		float* oy = offset_y.data();
+		for(size_t i = 0; i < count; ++i) {
+			float dx = bx[i] - ax[i];
+			float dy = by[i] - ay[i];
+			float length_sq = dx * dx + dy * dy;
+			// zero length segments get no offset, and so are not drawn
+			float scale = length_sq > 0 ? width[i] / (2 * std::sqrt(length_sq)) : 0;
+			ox[i] = -dy * scale;
+			oy[i] = dx * scale;
+		}
+
+		vertices.resize(count * 6);
+		sf::Vertex* out = vertices.data();
+		for(size_t i = 0; i < count; ++i, out += 6) {
+			const auto& colour = colours[i];
+			sf::Vertex a0({ax[i] + ox[i], ay[i] + oy[i]}, colour);
+			sf::Vertex a1({bx[i] + ox[i], by[i] + oy[i]}, colour);
+			sf::Vertex b1({bx[i] - ox[i], by[i] - oy[i]}, colour);
+			sf::Vertex b0({ax[i] - ox[i], ay[i] - oy[i]}, colour);
+
+			out[0] = a0;
+			out[1] = a1;
+			out[2] = b1;
+			out[3] = a0;
+			out[4] = b1;
+			out[5] = b0;
+		}
+
+		dirty = false;
+	}
+
+	void line_batch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		this->draw_to(target, states);
+	}
+
+	void line_batch::clear()
+	{
+		x0.clear();
+		y0.clear();
+		x1.clear();
+		y1.clear();
+		thickness.clear();
+		colours.clear();
+		vertices.clear();
+		dirty = false;
+	}
+
+	void line_batch::reserve(size_t segments)
+	{
+		x0.reserve(segments);
+		y0.reserve(segments);
+		x1.reserve(segments);
+		y1.reserve(segments);
+		thickness.reserve(segments);
+		colours.reserve(segments);
+	}
+
+	void line_batch::add(const sf::Vector2f& p0, const sf::Vector2f& p1, float width, const sf::Color& colour)
+	{
+		x0.push_back(p0.x);
+		y0.push_back(p0.y);
+		x1.push_back(p1.x);
+		y1.push_back(p1.y);
+		thickness.push_back(width);
+		colours.push_back(colour);
+		dirty = true;
+	}
+
+	void line_batch::add_segments(const sf::Vector2f* points, size_t count, float width, const sf::Color& colour)
+	{
+		for(size_t i = 0; i + 1 < count; i += 2) {
+			this->add(points[i], points[i + 1], width, colour);
+		}
+	}
+
+	void line_batch::add_polyline(const sf::Vector2f* points, size_t count, float width, const sf::Color& colour)
+	{
+		if(count < 2) {
+			return;
+		}
+		for(size_t i = 0; i + 1 < count; ++i) {
+			this->add(points[i], points[i + 1], width, colour);
+		}
+	}
+
+	size_t line_batch::size() const
+	{
+		return x0.size();
+	}
+
+	bool line_batch::empty() const
+	{
+		return x0.empty();
+	}
+
+	const std::vector<sf::Vertex>& line_batch::get_vertices() const
+	{
+		if(dirty) {
+			this->rebuild();
+		}
+		return vertices;
+	}
+
+	// }}}
+
+} // namespace disp
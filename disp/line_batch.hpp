@@ -0,0 +1,97 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <vector>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/drawable.hpp>
+#include <sfml/graphics/vertex.hpp>
+
+/**
+ * \file
+ * \brief Batched thick lines
+ *
+ * This provides disp::line_batch, which draws many thick lines in one draw
+ * call, for plots and debug overlays where one sf::LineShape per segment is
+ * too slow.
+ */
+
+namespace disp {
+
+	/**
+	 * \class line_batch
+	 * \brief Batch of thick line segments
+	 *
+	 * Segments are stored as separate arrays of coordinates, so the edge
+	 * offsets (as in sf::LineShape::getOffset) are computed for the whole
+	 * batch in one tight loop, which the compiler can vectorise. The
+	 * vertices are then built as two triangles per segment, and drawn with
+	 * a single call.
+	 *
+	 * The vertices are only rebuilt when segments have been added since the
+	 * last draw. Polylines are drawn as separate segments, so the joins of
+	 * very thick lines are not filled.
+	 */
+	class line_batch
+		: public sf::Drawable
+	{
+	private: // variables
+
+		// segments, as structure of arrays
+		std::vector<float> x0, y0, x1, y1;
+		std::vector<float> thickness;
+		std::vector<sf::Color> colours;
+
+		// built from the segments when drawn
+		mutable std::vector<float> offset_x, offset_y;
+		mutable std::vector<sf::Vertex> vertices;
+		mutable bool dirty;
+
+	private: // internal methods
+
+		void rebuild() const;
+
+	protected: // internal methods
+
+		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	public: // methods
+
+		line_batch();
+
+		/// Draw to any target with sf::RenderTarget's vertex draw, e.g. soft_target
+		template <typename Target>
+		void draw_to(Target& target, const sf::RenderStates& states) const
+		{
+			if(this->empty()) {
+				return;
+			}
+			const auto& verts = this->get_vertices();
+			target.draw(verts.data(), verts.size(), sf::Triangles, states);
+		}
+
+		/// Remove all segments, keeping the storage
+		void clear();
+
+		/// Reserve storage for \p segments segments
+		void reserve(size_t segments);
+
+		/// Add a segment from \p p0 to \p p1
+		void add(const sf::Vector2f& p0, const sf::Vector2f& p1, float width, const sf::Color& colour);
+
+		/// Add \p count / 2 segments, from pairs of points
+		void add_segments(const sf::Vector2f* points, size_t count, float width, const sf::Color& colour);
+
+		/// Add a line through \p count points
+		void add_polyline(const sf::Vector2f* points, size_t count, float width, const sf::Color& colour);
+
+		/// Number of segments
+		size_t size() const;
+		bool empty() const;
+
+		/// Vertices of the segments, as sf::Triangles
+		const std::vector<sf::Vertex>& get_vertices() const;
+
+	};
+
+} // namespace disp
@@ -0,0 +1,92 @@
+#include "quad_batch.hpp"
+
+#include <algorithm>
+
+#include <sfml/graphics/rendertarget.hpp>
+
+namespace disp {
+
+	// class quad_batch {{{
+
+	quad_batch::quad_batch()
+		: vertices(), runs()
+	{
+	}
+
+	sf::Vertex* quad_batch::append(const sf::Texture* texture)
+	{
+		if(runs.empty() || runs.back().texture != texture) {
+			runs.push_back(run{texture, vertices.size(), 0});
+		}
+		runs.back().count += 4;
+
+		vertices.resize(vertices.size() + 4);
+		return &vertices[vertices.size() - 4];
+	}
+
+	void quad_batch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		this->draw_to(target, states);
+	}
+
+	void quad_batch::clear()
+	{
+		vertices.clear();
+		runs.clear();
+	}
+
+	void quad_batch::reserve(size_t quads)
+	{
+		vertices.reserve(quads * 4);
+	}
+
+	void quad_batch::add(const sf::FloatRect& rect, const sf::Color& colour)
+	{
+		auto quad = this->append(nullptr);
+		float right = rect.left + rect.width;
+		float bottom = rect.top + rect.height;
+
+		quad[0] = sf::Vertex({rect.left, rect.top}, colour);
+		quad[1] = sf::Vertex({right, rect.top}, colour);
+		quad[2] = sf::Vertex({right, bottom}, colour);
+		quad[3] = sf::Vertex({rect.left, bottom}, colour);
+	}
+
+	void quad_batch::add(const sf::FloatRect& rect, const sf::Texture& texture, const sf::FloatRect& tex_rect,
+	                     const sf::Color& colour)
+	{
+		auto quad = this->append(&texture);
+		float right = rect.left + rect.width;
+		float bottom = rect.top + rect.height;
+		float u1 = tex_rect.left + tex_rect.width;
+		float v1 = tex_rect.top + tex_rect.height;
+
+		quad[0] = sf::Vertex({rect.left, rect.top}, colour, {tex_rect.left, tex_rect.top});
+		quad[1] = sf::Vertex({right, rect.top}, colour, {u1, tex_rect.top});
+		quad[2] = sf::Vertex({right, bottom}, colour, {u1, v1});
+		quad[3] = sf::Vertex({rect.left, bottom}, colour, {tex_rect.left, v1});
+	}
+
+	void quad_batch::add(const sf::Vertex* quad, const sf::Texture* texture)
+	{
+		std::copy(quad, quad + 4, this->append(texture));
+	}
+
+	size_t quad_batch::size() const
+	{
+		return vertices.size() / 4;
+	}
+
+	bool quad_batch::empty() const
+	{
+		return vertices.empty();
+	}
+
+	size_t quad_batch::run_count() const
+	{
+		return runs.size();
+	}
+
+	// }}}
+
+} // namespace disp
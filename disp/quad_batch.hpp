@@ -0,0 +1,103 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <vector>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/drawable.hpp>
+#include <sfml/graphics/rect.hpp>
+#include <sfml/graphics/texture.hpp>
+#include <sfml/graphics/vertex.hpp>
+
+/**
+ * \file
+ * \brief Batched quad drawing
+ *
+ * This provides disp::quad_batch, which draws many rectangles with as few
+ * draw calls as possible, instead of one sf::RectangleShape draw each.
+ */
+
+namespace disp {
+
+	/**
+	 * \class quad_batch
+	 * \brief Batch of coloured and textured quads
+	 *
+	 * Quads are added each frame, and drawn together with one draw call
+	 * for each run of quads with the same texture. The vertex storage is
+	 * kept between frames, so clear() and re-adding does not allocate once
+	 * the batch has reached its working size.
+	 *
+	 * Quads are drawn in the order they were added. To keep the number of
+	 * runs low, add quads with the same texture together.
+	 *
+	 * Textures are not owned, and must outlive the batch, or until the
+	 * next clear().
+	 */
+	class quad_batch
+		: public sf::Drawable
+	{
+	private: // statics
+
+		// quads with the same texture, drawn together
+		struct run
+		{
+			const sf::Texture* texture;
+			size_t first; // index of the first vertex
+			size_t count; // number of vertices
+		};
+
+	private: // variables
+
+		std::vector<sf::Vertex> vertices;
+		std::vector<run> runs;
+
+	private: // internal methods
+
+		// adds to the last run, or starts a new one if the texture differs
+		sf::Vertex* append(const sf::Texture* texture);
+
+	protected: // internal methods
+
+		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	public: // methods
+
+		/// Draw to any target with sf::RenderTarget's vertex draw, e.g. soft_target
+		template <typename Target>
+		void draw_to(Target& target, sf::RenderStates states) const
+		{
+			for(auto& r : runs) {
+				states.texture = r.texture;
+				target.draw(&vertices[r.first], r.count, sf::Quads, states);
+			}
+		}
+
+		quad_batch();
+
+		/// Remove all quads, keeping the storage
+		void clear();
+
+		/// Reserve storage for \p quads quads
+		void reserve(size_t quads);
+
+		/// Add a quad of a single colour
+		void add(const sf::FloatRect& rect, const sf::Color& colour);
+
+		/// Add a textured quad, with \p tex_rect in pixels
+		void add(const sf::FloatRect& rect, const sf::Texture& texture, const sf::FloatRect& tex_rect,
+		         const sf::Color& colour = sf::Color::White);
+
+		/// Add a quad from 4 vertices in order, with an optional texture
+		void add(const sf::Vertex* quad, const sf::Texture* texture = nullptr);
+
+		/// Number of quads
+		size_t size() const;
+		bool empty() const;
+
+		/// Number of draw calls needed for the batch
+		size_t run_count() const;
+
+	};
+
+} // namespace disp
@@ -0,0 +1,119 @@
+#include "render_thread.hpp"
+
+#include <utility>
+
+namespace disp {
+
+	// class render_thread {{{
+
+	render_thread::render_thread(sf::RenderWindow& target, const sf::Color& init_background)
+		: window(target), background(init_background)
+		, thread(), lock(), cond()
+		, next(), has_next(false), running(false)
+		, stats{0, 0, 0}
+	{
+	}
+
+	render_thread::~render_thread()
+	{
+		this->stop();
+	}
+
+	void render_thread::run()
+	{
+		window.setActive(true);
+
+		command_buffer current;
+		while(true) {
+			sf::Color clear_colour;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				cond.wait(guard, [this] { return has_next || !running; });
+				if(!has_next) {
+					break;
+				}
+				// the finished frame goes back to be reused by submit()
+				std::swap(current, next);
+				has_next = false;
+				clear_colour = background;
+			}
+			cond.notify_all();
+
+			window.clear(clear_colour);
+			window.draw(current);
+			window.display();
+
+			auto frame_stats = current.get_stats();
+			std::lock_guard<std::mutex> guard(lock);
+			++stats.frames;
+			stats.commands = frame_stats.commands;
+			stats.draw_calls = frame_stats.draw_calls;
+		}
+
+		window.setActive(false);
+	}
+
+	void render_thread::start()
+	{
+		if(thread.joinable()) {
+			return;
+		}
+		running = true;
+		window.setActive(false);
+		thread = std::thread(&render_thread::run, this);
+	}
+
+	void render_thread::stop()
+	{
+		if(!thread.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			running = false;
+		}
+		cond.notify_all();
+		thread.join();
+		window.setActive(true);
+	}
+
+	bool render_thread::is_running() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return running;
+	}
+
+	void render_thread::set_background(const sf::Color& new_background)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		background = new_background;
+	}
+
+	command_buffer render_thread::submit(command_buffer frame)
+	{
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			cond.wait(guard, [this] { return !has_next || !running; });
+			if(!running) {
+				frame.clear();
+				return frame;
+			}
+			std::swap(next, frame);
+			has_next = true;
+		}
+		cond.notify_all();
+
+		// this has the storage of a frame which has been drawn
+		frame.clear();
+		return frame;
+	}
+
+	render_thread::statistics render_thread::get_stats() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return stats;
+	}
+
+	// }}}
+
+} // namespace disp
@@ -0,0 +1,103 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/renderwindow.hpp>
+
+#include "command_buffer.hpp"
+
+/**
+ * \file
+ * \brief Drawing on a separate thread
+ *
+ * This provides disp::render_thread, which draws recorded frames to a window
+ * from its own thread, so building a frame does not wait for OpenGL.
+ */
+
+namespace disp {
+
+	/**
+	 * \class render_thread
+	 * \brief Thread owning a window's OpenGL context
+	 *
+	 * Once started, the thread takes the window's context, and for each
+	 * frame given to submit() clears the window, draws the frame's
+	 * command_buffer and displays it. The frame limit of the window (see
+	 * stdwindow::winfps) is then applied on this thread.
+	 *
+	 * At most one frame waits to be drawn. submit() blocks while there is
+	 * one, so the frame being built is never more than one frame ahead of
+	 * the frame being drawn. Buffers are recycled between the two threads,
+	 * so recording does not allocate once the buffers are large enough.
+	 *
+	 * Events must still be polled on the thread which created the window,
+	 * and nothing else may draw to the window while the thread runs. Stop
+	 * it before closing the window, e.g. on sf::Event::Closed.
+	 */
+	class render_thread
+	{
+	public: // statics
+
+		struct statistics
+		{
+			uint64_t frames; // frames drawn
+			size_t commands; // commands in the last frame
+			size_t draw_calls; // draw calls for the last frame
+		};
+
+	private: // variables
+
+		sf::RenderWindow& window;
+		sf::Color background;
+
+		std::thread thread;
+		mutable std::mutex lock;
+		std::condition_variable cond;
+
+		command_buffer next; // submitted, waiting to be drawn
+		bool has_next;
+		bool running;
+
+		statistics stats;
+
+	private: // internal methods
+
+		void run();
+
+	public: // methods
+
+		explicit render_thread(sf::RenderWindow& target, const sf::Color& init_background = sf::Color::Black);
+		~render_thread();
+
+		render_thread(const render_thread&) = delete;
+		render_thread& operator=(const render_thread&) = delete;
+
+		/// Take the window's context from the calling thread, and start drawing
+		void start();
+
+		/// Draw any waiting frame, then give the context back to the calling thread
+		void stop();
+
+		bool is_running() const;
+
+		void set_background(const sf::Color& new_background);
+
+		/**
+		 * \fn submit
+		 * \brief Hand over a frame to be drawn
+		 *
+		 * Waits until the previous frame has been taken, and returns an
+		 * empty buffer to record the next frame into.
+		 */
+		command_buffer submit(command_buffer frame);
+
+		statistics get_stats() const;
+
+	};
+
+} // namespace disp
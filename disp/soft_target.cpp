@@ -0,0 +1,497 @@
+#include "soft_target.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace { // anonymous
+
+	// vertex positions are snapped to 1/256 of a pixel, so the edge functions
+	// are exact, and a pixel on an edge shared by two triangles is in exactly one
+	const int subpixel_bits = 8;
+	const int64_t subpixel_limit = int64_t(1) << 29;
+
+	struct fixed_point
+	{
+		int64_t x, y;
+	};
+
+	int64_t to_fixed(float value)
+	{
+		float scaled = value * (1 << subpixel_bits);
+		return std::max(-subpixel_limit, std::min(subpixel_limit, int64_t(std::lround(scaled))));
+	}
+
+	// twice the signed area of (a, b, p), positive if p is clockwise of a to b on screen
+	int64_t edge(const fixed_point& a, const fixed_point& b, int64_t px, int64_t py)
+	{
+		return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+	}
+
+	// pixels exactly on a top or left edge are drawn, so shared edges are drawn once
+	bool top_left(const fixed_point& from, const fixed_point& to)
+	{
+		int64_t dx = to.x - from.x;
+		int64_t dy = to.y - from.y;
+		return dy < 0 || (dy == 0 && dx > 0);
+	}
+
+	uint8_t to_channel(float value)
+	{
+		return uint8_t(std::min(255.f, std::max(0.f, value)) + 0.5f);
+	}
+
+} // namespace anonymous
+
+namespace disp {
+
+	// class soft_target {{{
+
+	soft_target::soft_target(unsigned int init_width, unsigned int init_height, unsigned int threads)
+		: width(init_width), height(init_height), pixels(size_t(init_width) * init_height * 4, 0)
+		, view(sf::FloatRect(0, 0, float(init_width), float(init_height))), images(), pending(), bins()
+		, thread_count(threads), helpers(), work_lock(), work_cv(), done_cv(), generation(0), busy(0), stopping(false)
+		, tiles_x(0), tile_count(0), next_tile(0)
+	{
+		if(thread_count == 0) {
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		this->clear();
+
+		for(unsigned i = 1; i < thread_count; ++i) {
+			helpers.emplace_back([this] { this->helper_loop(); });
+		}
+	}
+
+	soft_target::~soft_target()
+	{
+		{
+			std::lock_guard<std::mutex> guard(work_lock);
+			stopping = true;
+		}
+		work_cv.notify_all();
+		for(auto& helper : helpers) {
+			helper.join();
+		}
+	}
+
+	void soft_target::helper_loop()
+	{
+		uint64_t seen = 0;
+		while(true) {
+			{
+				std::unique_lock<std::mutex> lock(work_lock);
+				work_cv.wait(lock, [&] { return stopping || generation != seen; });
+				if(stopping) {
+					return;
+				}
+				seen = generation;
+			}
+
+			this->raster_tiles();
+
+			{
+				std::lock_guard<std::mutex> guard(work_lock);
+				--busy;
+			}
+			done_cv.notify_one();
+		}
+	}
+
+	void soft_target::raster_tiles()
+	{
+		// tiles do not overlap, so each can be drawn by any thread
+		for(unsigned tile; (tile = next_tile++) < tile_count; ) {
+			this->raster_tile(tile % tiles_x, tile / tiles_x, bins[tile]);
+		}
+	}
+
+	soft_target::raster_vertex soft_target::to_raster(const sf::Vertex& vertex, const sf::Transform& transform) const
+	{
+		// to normalised device coordinates, then to the viewport in pixels
+		auto ndc = transform.transformPoint(vertex.position);
+		auto& viewport = view.getViewport();
+
+		raster_vertex out;
+		out.x = (viewport.left + (ndc.x + 1) / 2 * viewport.width) * width;
+		out.y = (viewport.top + (1 - ndc.y) / 2 * viewport.height) * height;
+		out.r = vertex.color.r;
+		out.g = vertex.color.g;
+		out.b = vertex.color.b;
+		out.a = vertex.color.a;
+		out.u = vertex.texCoords.x;
+		out.v = vertex.texCoords.y;
+		return out;
+	}
+
+	void soft_target::add(primitive_kind kind, const raster_vertex* v, const sf::Image* image, blend_type blend)
+	{
+		primitive prim;
+		std::copy(v, v + (kind == kind_triangle ? 3 : kind == kind_line ? 2 : 1), prim.v);
+		prim.image = image;
+		prim.blend = blend;
+		prim.kind = kind;
+		pending.push_back(prim);
+	}
+
+	void soft_target::plot(int x, int y, const raster_vertex& v, const sf::Image* image, blend_type blend)
+	{
+		float r = v.r, g = v.g, b = v.b, a = v.a;
+		if(image) {
+			auto size = image->getSize();
+			unsigned tx = unsigned(std::min(std::max(v.u, 0.f), float(size.x - 1)));
+			unsigned ty = unsigned(std::min(std::max(v.v, 0.f), float(size.y - 1)));
+			auto texel = image->getPixelsPtr() + (size_t(ty) * size.x + tx) * 4;
+			r = r * texel[0] / 255;
+			g = g * texel[1] / 255;
+			b = b * texel[2] / 255;
+			a = a * texel[3] / 255;
+		}
+
+		uint8_t* dest = &pixels[(size_t(y) * width + x) * 4];
+		float alpha = a / 255;
+		switch(blend) {
+		case blend_alpha:
+			dest[0] = to_channel(r * alpha + dest[0] * (1 - alpha));
+			dest[1] = to_channel(g * alpha + dest[1] * (1 - alpha));
+			dest[2] = to_channel(b * alpha + dest[2] * (1 - alpha));
+			dest[3] = to_channel(a + dest[3] * (1 - alpha));
+			break;
+		case blend_add:
+			dest[0] = to_channel(r * alpha + dest[0]);
+			dest[1] = to_channel(g * alpha + dest[1]);
+			dest[2] = to_channel(b * alpha + dest[2]);
+			dest[3] = to_channel(a + dest[3]);
+			break;
+		case blend_none:
+			dest[0] = to_channel(r);
+			dest[1] = to_channel(g);
+			dest[2] = to_channel(b);
+			dest[3] = to_channel(a);
+			break;
+		}
+	}
+
+	void soft_target::raster_triangle(const primitive& prim, int x0, int y0, int x1, int y1)
+	{
+		const raster_vertex* a = &prim.v[0];
+		const raster_vertex* b = &prim.v[1];
+		const raster_vertex* c = &prim.v[2];
+		fixed_point fa{to_fixed(a->x), to_fixed(a->y)};
+		fixed_point fb{to_fixed(b->x), to_fixed(b->y)};
+		fixed_point fc{to_fixed(c->x), to_fixed(c->y)};
+
+		int64_t area = edge(fa, fb, fc.x, fc.y);
+		if(area == 0) {
+			return;
+		}
+		if(area < 0) {
+			std::swap(b, c);
+			std::swap(fb, fc);
+			area = -area;
+		}
+
+		// bounds of the triangle within the tile
+		int min_x = std::max(x0, int(std::floor(std::min({a->x, b->x, c->x}))));
+		int min_y = std::max(y0, int(std::floor(std::min({a->y, b->y, c->y}))));
+		int max_x = std::min(x1 - 1, int(std::ceil(std::max({a->x, b->x, c->x}))));
+		int max_y = std::min(y1 - 1, int(std::ceil(std::max({a->y, b->y, c->y}))));
+
+		bool tl0 = top_left(fb, fc);
+		bool tl1 = top_left(fc, fa);
+		bool tl2 = top_left(fa, fb);
+		const int64_t half = int64_t(1) << (subpixel_bits - 1);
+
+		for(int y = min_y; y <= max_y; ++y) {
+			int64_t py = (int64_t(y) << subpixel_bits) + half;
+			for(int x = min_x; x <= max_x; ++x) {
+				int64_t px = (int64_t(x) << subpixel_bits) + half;
+				int64_t e0 = edge(fb, fc, px, py);
+				int64_t e1 = edge(fc, fa, px, py);
+				int64_t e2 = edge(fa, fb, px, py);
+
+				if((e0 < 0 || (e0 == 0 && !tl0))
+				|| (e1 < 0 || (e1 == 0 && !tl1))
+				|| (e2 < 0 || (e2 == 0 && !tl2))) {
+					continue;
+				}
+
+				// barycentric weights of a, b and c
+				float w0 = float(e0) / area;
+				float w1 = float(e1) / area;
+				float w2 = float(e2) / area;
+
+				raster_vertex v;
+				v.r = a->r * w0 + b->r * w1 + c->r * w2;
+				v.g = a->g * w0 + b->g * w1 + c->g * w2;
+				v.b = a->b * w0 + b->b * w1 + c->b * w2;
+				v.a = a->a * w0 + b->a * w1 + c->a * w2;
+				v.u = a->u * w0 + b->u * w1 + c->u * w2;
+				v.v = a->v * w0 + b->v * w1 + c->v * w2;
+				this->plot(x, y, v, prim.image, prim.blend);
+			}
+		}
+	}
+
+	void soft_target::raster_line(const primitive& prim, int x0, int y0, int x1, int y1)
+	{
+		const auto& a = prim.v[0];
+		const auto& b = prim.v[prim.kind == kind_line ? 1 : 0];
+
+		float dx = b.x - a.x;
+		float dy = b.y - a.y;
+		int steps = std::max(1, int(std::ceil(std::max(std::abs(dx), std::abs(dy)))));
+
+		for(int i = 0; i < steps; ++i) {
+			float t = (i + 0.5f) / steps;
+			int x = int(std::floor(a.x + dx * t));
+			int y = int(std::floor(a.y + dy * t));
+			if(x < x0 || x >= x1 || y < y0 || y >= y1) {
+				continue;
+			}
+
+			raster_vertex v;
+			v.r = a.r + (b.r - a.r) * t;
+			v.g = a.g + (b.g - a.g) * t;
+			v.b = a.b + (b.b - a.b) * t;
+			v.a = a.a + (b.a - a.a) * t;
+			v.u = a.u + (b.u - a.u) * t;
+			v.v = a.v + (b.v - a.v) * t;
+			this->plot(x, y, v, prim.image, prim.blend);
+		}
+	}
+
+	void soft_target::raster_tile(unsigned tile_x, unsigned tile_y, const std::vector<uint32_t>& bin)
+	{
+		int x0 = int(tile_x * tile_size);
+		int y0 = int(tile_y * tile_size);
+		int x1 = int(std::min(width, (tile_x + 1) * tile_size));
+		int y1 = int(std::min(height, (tile_y + 1) * tile_size));
+
+		for(auto index : bin) {
+			auto& prim = pending[index];
+			if(prim.kind == kind_triangle) {
+				this->raster_triangle(prim, x0, y0, x1, y1);
+			} else {
+				this->raster_line(prim, x0, y0, x1, y1);
+			}
+		}
+	}
+
+	sf::Vector2u soft_target::getSize() const
+	{
+		return sf::Vector2u(width, height);
+	}
+
+	void soft_target::setView(const sf::View& new_view)
+	{
+		view = new_view;
+	}
+
+	const sf::View& soft_target::getView() const
+	{
+		return view;
+	}
+
+	sf::View soft_target::getDefaultView() const
+	{
+		return sf::View(sf::FloatRect(0, 0, float(width), float(height)));
+	}
+
+	void soft_target::set_texture_image(const sf::Texture& texture, const sf::Image& image)
+	{
+		images[&texture] = &image;
+	}
+
+	void soft_target::clear(const sf::Color& colour)
+	{
+		pending.clear();
+		for(size_t i = 0; i < pixels.size(); i += 4) {
+			pixels[i + 0] = colour.r;
+			pixels[i + 1] = colour.g;
+			pixels[i + 2] = colour.b;
+			pixels[i + 3] = colour.a;
+		}
+	}
+
+	void soft_target::draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+	                       const sf::RenderStates& states)
+	{
+		const sf::Image* image = nullptr;
+		if(states.texture) {
+			auto it = images.find(states.texture);
+			if(it != images.end()) {
+				image = it->second;
+			}
+		}
+		this->draw_image(vertices, count, type, image, states);
+	}
+
+	void soft_target::draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+	                       const sf::Image& image, const sf::RenderStates& states)
+	{
+		this->draw_image(vertices, count, type, &image, states);
+	}
+
+	void soft_target::draw_image(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+	                             const sf::Image* image, const sf::RenderStates& states)
+	{
+		if(count == 0) {
+			return;
+		}
+
+		blend_type blend = blend_alpha;
+		if(states.blendMode == sf::BlendAdd) {
+			blend = blend_add;
+		} else if(states.blendMode == sf::BlendNone) {
+			blend = blend_none;
+		}
+
+		sf::Transform transform = view.getTransform() * states.transform;
+		std::vector<raster_vertex> v(count);
+		for(size_t i = 0; i < count; ++i) {
+			v[i] = this->to_raster(vertices[i], transform);
+		}
+
+		switch(type) {
+		case sf::Points:
+			for(size_t i = 0; i < count; ++i) {
+				this->add(kind_point, &v[i], image, blend);
+			}
+			break;
+		case sf::Lines:
+			for(size_t i = 0; i + 1 < count; i += 2) {
+				this->add(kind_line, &v[i], image, blend);
+			}
+			break;
+		case sf::LineStrip:
+			for(size_t i = 0; i + 1 < count; ++i) {
+				this->add(kind_line, &v[i], image, blend);
+			}
+			break;
+		case sf::Triangles:
+			for(size_t i = 0; i + 2 < count; i += 3) {
+				this->add(kind_triangle, &v[i], image, blend);
+			}
+			break;
+		case sf::TriangleStrip:
+			for(size_t i = 0; i + 2 < count; ++i) {
+				this->add(kind_triangle, &v[i], image, blend);
+			}
+			break;
+		case sf::TriangleFan:
+			for(size_t i = 1; i + 1 < count; ++i) {
+				raster_vertex tri[3] = {v[0], v[i], v[i + 1]};
+				this->add(kind_triangle, tri, image, blend);
+			}
+			break;
+		case sf::Quads:
+			for(size_t i = 0; i + 3 < count; i += 4) {
+				raster_vertex second[3] = {v[i], v[i + 2], v[i + 3]};
+				this->add(kind_triangle, &v[i], image, blend);
+				this->add(kind_triangle, second, image, blend);
+			}
+			break;
+		}
+	}
+
+	void soft_target::display()
+	{
+		if(pending.empty()) {
+			return;
+		}
+
+		tiles_x = (width + tile_size - 1) / tile_size;
+		unsigned tiles_y = (height + tile_size - 1) / tile_size;
+		tile_count = tiles_x * tiles_y;
+
+		// sort the primitives into the tiles they touch, keeping their order
+		bins.resize(tile_count);
+		for(auto& bin : bins) {
+			bin.clear();
+		}
+		for(size_t i = 0; i < pending.size(); ++i) {
+			auto& prim = pending[i];
+			int points = prim.kind == kind_triangle ? 3 : prim.kind == kind_line ? 2 : 1;
+			float min_x = prim.v[0].x, max_x = prim.v[0].x;
+			float min_y = prim.v[0].y, max_y = prim.v[0].y;
+			for(int p = 1; p < points; ++p) {
+				min_x = std::min(min_x, prim.v[p].x);
+				max_x = std::max(max_x, prim.v[p].x);
+				min_y = std::min(min_y, prim.v[p].y);
+				max_y = std::max(max_y, prim.v[p].y);
+			}
+			if(max_x < 0 || max_y < 0 || min_x >= width || min_y >= height) {
+				continue;
+			}
+
+			unsigned first_x = unsigned(std::max(0.f, min_x)) / tile_size;
+			unsigned first_y = unsigned(std::max(0.f, min_y)) / tile_size;
+			unsigned last_x = std::min(tiles_x - 1, unsigned(max_x) / tile_size);
+			unsigned last_y = std::min(tiles_y - 1, unsigned(max_y) / tile_size);
+			for(unsigned ty = first_y; ty <= last_y; ++ty) {
+				for(unsigned tx = first_x; tx <= last_x; ++tx) {
+					bins[ty * tiles_x + tx].push_back(uint32_t(i));
+				}
+			}
+		}
+
+		next_tile = 0;
+		if(helpers.empty()) {
+			this->raster_tiles();
+		} else {
+			{
+				std::lock_guard<std::mutex> guard(work_lock);
+				busy = unsigned(helpers.size());
+				++generation;
+			}
+			work_cv.notify_all();
+			this->raster_tiles();
+
+			// the bins and pending primitives are in use until every helper is done
+			std::unique_lock<std::mutex> lock(work_lock);
+			done_cv.wait(lock, [this] { return busy == 0; });
+		}
+
+		pending.clear();
+	}
+
+	const uint8_t* soft_target::get_pixels() const
+	{
+		return pixels.data();
+	}
+
+	sf::Image soft_target::capture()
+	{
+		this->display();
+		sf::Image image;
+		image.create(width, height, pixels.data());
+		return image;
+	}
+
+	size_t soft_target::difference(const sf::Image& lhs, const sf::Image& rhs, unsigned int tolerance)
+	{
+		auto size = lhs.getSize();
+		if(size != rhs.getSize()) {
+			return size_t(std::max(size.x * size.y, rhs.getSize().x * rhs.getSize().y));
+		}
+
+		const uint8_t* a = lhs.getPixelsPtr();
+		const uint8_t* b = rhs.getPixelsPtr();
+		size_t count = 0;
+		for(size_t i = 0; i < size_t(size.x) * size.y; ++i, a += 4, b += 4) {
+			for(int c = 0; c < 4; ++c) {
+				if(unsigned(std::abs(int(a[c]) - int(b[c]))) > tolerance) {
+					++count;
+					break;
+				}
+			}
+		}
+		return count;
+	}
+
+	// }}}
+
+} // namespace disp
@@ -0,0 +1,190 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sfml/graphics/color.hpp>
+#include <sfml/graphics/image.hpp>
+#include <sfml/graphics/primitivetype.hpp>
+#include <sfml/graphics/renderstates.hpp>
+#include <sfml/graphics/texture.hpp>
+#include <sfml/graphics/vertex.hpp>
+#include <sfml/graphics/view.hpp>
+
+/**
+ * \file
+ * \brief CPU render target
+ *
+ * This provides disp::soft_target, which rasterises into memory instead of
+ * through OpenGL, for rendering on hosts without a GPU or display (e.g.
+ * benchmarks and image comparisons in automated builds). Programs using the
+ * runtime draw to one through stdwindow::render() when run with --headless.
+ */
+
+namespace disp {
+
+	/**
+	 * \class soft_target
+	 * \brief Render target rasterising on the CPU
+	 *
+	 * This has the same vertex draw() as sf::RenderTarget, so the batches in
+	 * disp (quad_batch, line_batch, glyph_text) can draw to either through
+	 * their draw_to(). Draws are recorded, then rasterised by display() or
+	 * capture(), with the framebuffer split into tiles shared between
+	 * threads, which are started with the target. Each tile draws its primitives in submission order, so the
+	 * result does not depend on the number of threads.
+	 *
+	 * Triangles, strips, fans and quads are filled; points and lines are
+	 * drawn one pixel wide. Colours and texture coordinates are
+	 * interpolated, textures are sampled with the nearest texel, and the
+	 * alpha, add and none blend modes are supported. Shaders are ignored.
+	 *
+	 * As textures live on the GPU, each texture drawn from needs a copy of
+	 * its image given to set_texture_image(). Vertices with a texture which
+	 * has no image are drawn with their colour alone. Without a display, no
+	 * sf::Texture can be made, so an image can be drawn from directly
+	 * instead (e.g. glyph_text with set_glyphs() given an image).
+	 */
+	class soft_target
+	{
+	private: // statics
+
+		enum blend_type : uint8_t
+		{
+			blend_alpha,
+			blend_add,
+			blend_none
+		};
+
+		// a vertex in pixel coordinates
+		struct raster_vertex
+		{
+			float x, y;
+			float r, g, b, a;
+			float u, v;
+		};
+
+		enum primitive_kind : uint8_t
+		{
+			kind_triangle,
+			kind_line,
+			kind_point
+		};
+
+		struct primitive
+		{
+			raster_vertex v[3]; // only the first 1 or 2 for points and lines
+			const sf::Image* image;
+			blend_type blend;
+			primitive_kind kind;
+		};
+
+		static constexpr unsigned tile_size = 64;
+
+	private: // variables
+
+		unsigned width;
+		unsigned height;
+		std::vector<uint8_t> pixels; // RGBA
+
+		sf::View view;
+		std::map<const sf::Texture*, const sf::Image*> images;
+
+		std::vector<primitive> pending;
+		std::vector<std::vector<uint32_t>> bins; // pending primitives touching each tile
+		unsigned thread_count;
+
+		// helpers live as long as the target, and wake for each display()
+		std::vector<std::thread> helpers;
+		std::mutex work_lock;
+		std::condition_variable work_cv;
+		std::condition_variable done_cv;
+		uint64_t generation;
+		unsigned busy;
+		bool stopping;
+
+		// the tiles of the current display()
+		unsigned tiles_x;
+		unsigned tile_count;
+		std::atomic<unsigned> next_tile;
+
+	private: // internal methods
+
+		raster_vertex to_raster(const sf::Vertex& vertex, const sf::Transform& transform) const;
+
+		void draw_image(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+		                const sf::Image* image, const sf::RenderStates& states);
+
+		void add(primitive_kind kind, const raster_vertex* v, const sf::Image* image, blend_type blend);
+
+		void helper_loop();
+		void raster_tiles();
+		void raster_tile(unsigned tile_x, unsigned tile_y, const std::vector<uint32_t>& bin);
+		void raster_triangle(const primitive& prim, int x0, int y0, int x1, int y1);
+		void raster_line(const primitive& prim, int x0, int y0, int x1, int y1);
+		void plot(int x, int y, const raster_vertex& v, const sf::Image* image, blend_type blend);
+
+	public: // methods
+
+		/// Create with a framebuffer, using a thread per core if \p threads is 0
+		explicit soft_target(unsigned int init_width, unsigned int init_height, unsigned int threads = 0);
+
+		soft_target(const soft_target&) = delete;
+		soft_target& operator=(const soft_target&) = delete;
+
+		~soft_target();
+
+		sf::Vector2u getSize() const;
+
+		void setView(const sf::View& new_view);
+		const sf::View& getView() const;
+		sf::View getDefaultView() const;
+
+		/// Set the image used for a texture, which must outlive its use
+		void set_texture_image(const sf::Texture& texture, const sf::Image& image);
+
+		/// Clear to a colour, discarding pending draws
+		void clear(const sf::Color& colour = sf::Color::Black);
+
+		/// Same as sf::RenderTarget::draw
+		void draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+		          const sf::RenderStates& states = sf::RenderStates::Default);
+
+		/// Same, sampling \p image instead of the texture, which must outlive the draw
+		void draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+		          const sf::Image& image, const sf::RenderStates& states = sf::RenderStates::Default);
+
+		/// Draw a batch from disp, e.g. quad_batch
+		template <typename T>
+		void draw(const T& drawable, const sf::RenderStates& states = sf::RenderStates::Default)
+		{
+			drawable.draw_to(*this, states);
+		}
+
+		/// Rasterise pending draws
+		void display();
+
+		/// Raw RGBA pixels, after display()
+		const uint8_t* get_pixels() const;
+
+		/// Rasterise, and copy the framebuffer to an image
+		sf::Image capture();
+
+		/**
+		 * \fn difference
+		 * \brief Compare images, e.g. against a reference
+		 *
+		 * Returns the number of pixels where any channel differs by
+		 * more than \p tolerance, or every pixel if the sizes differ.
+		 */
+		static size_t difference(const sf::Image& lhs, const sf::Image& rhs, unsigned int tolerance = 0);
+
+	};
+
+} // namespace disp
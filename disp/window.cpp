@@ -1,17 +1,31 @@
 #include "window.hpp"
 
+#include <stdexcept>
+
 // class stdwindow {{{
 
 int stdwindow::winstyle;
 int stdwindow::winfps;
 vec2i stdwindow::winsize;
+signal<stdwindow::time_point, stdwindow::time_point> stdwindow::on_display;
+bool stdwindow::headless = false;
 
 stdwindow::window_type& stdwindow::get_win()
 {
+	// creating any window or texture needs a display
+	if(headless) {
+		throw std::logic_error("the window is not available when headless");
+	}
 	static window_type win;
 	return win;
 }
 
+std::unique_ptr<disp::soft_target>& stdwindow::get_soft()
+{
+	static std::unique_ptr<disp::soft_target> target;
+	return target;
+}
+
 // base accessors
 
 stdwindow::window_type& stdwindow::window()
@@ -24,18 +38,41 @@ const stdwindow::window_type& stdwindow::window() const
 	return get_win();
 }
 
+disp::soft_target& stdwindow::soft()
+{
+	return *get_soft();
+}
+
 // helpers
 
 void stdwindow::init()
 {
+	if(headless) {
+		get_soft().reset(new disp::soft_target(unsigned(winsize.x), unsigned(winsize.y)));
+		return;
+	}
 	this->window().create(sf::VideoMode(winsize.x, winsize.y), winname, winstyle);
 	if(winfps > 0) {
 		this->window().setFramerateLimit(winfps);
 	}
 }
 
+void stdwindow::display()
+{
+	auto start = std::chrono::steady_clock::now();
+	if(headless) {
+		this->soft().display();
+	} else {
+		this->window().display();
+	}
+	on_display(start, std::chrono::steady_clock::now());
+}
+
 stdwindow::operator bool() const
 {
+	if(headless) {
+		return bool(get_soft());
+	}
 	return this->window().isOpen();
 }
 
@@ -1,10 +1,15 @@
 /* -*- cpp.doxygen -*- */
 #pragma once
 
+#include <chrono>
+#include <memory>
+
 #include <sfml/window.hpp>
 #include <sfml/graphics/renderwindow.hpp>
 
+#include "include/sigslots.hpp"
 #include "include/vector.hpp"
+#include "soft_target.hpp"
 
 /**
  * \file
@@ -25,6 +30,11 @@
  * If using the provided main(), the configuration can be modified using
  * command line arguments.
  *
+ * With #headless set, init() creates a disp::soft_target instead of a window,
+ * for hosts without a display or GPU. Programs which can run this way draw
+ * through render(), which passes whichever target is in use, and the window
+ * itself is not available.
+ *
  * \warning
  * The init() method must be called before using the window. If you're using
  * the provided main() in the runtime, this is already done for you.
@@ -48,9 +58,19 @@ public: // statics
 	/// Window drawable area size
 	static vec2i winsize;
 
+	/// Time points passed to on_display
+	using time_point = std::chrono::steady_clock::time_point;
+
+	/// Called after display(), with the times it was called and returned
+	static signal<time_point, time_point> on_display;
+
+	/// Draw into a disp::soft_target instead of a window, set before init()
+	static bool headless;
+
 private: // internal statics
 
 	static window_type& get_win();
+	static std::unique_ptr<disp::soft_target>& get_soft();
 
 public: // methods
 
@@ -60,11 +80,32 @@ public: // methods
 	window_type& window();
 	const window_type& window() const;
 
+	/// The target drawn to when #headless, after init()
+	disp::soft_target& soft();
+
+	/**
+	 * Call \p fn with the target in use, either the window or the
+	 * soft_target, e.g. with a generic lambda which draws the frame.
+	 * Only disp batches and vertices can be drawn to both.
+	 */
+	template <typename F>
+	void render(F&& fn)
+	{
+		if(headless) {
+			fn(this->soft());
+		} else {
+			fn(this->window());
+		}
+	}
+
 	// helpers
 
 	/// Initialise the window, using the static variables. Do not initialise more than once
 	void init();
 
+	/// Show the frame, as sf::Window::display, then call on_display
+	void display();
+
 	/// Find if the window has been initialised
 	explicit operator bool() const;
 	bool operator!() const;
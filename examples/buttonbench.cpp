@@ -0,0 +1,168 @@
+// measures how many button state transitions and mouse events per second are
+// handled, by single buttons and through a switchboard
+// argv: [buttons per side]
+//
+// clicks are presses and releases on each button, and moves go over each
+// button and then off it; there is no window, so focus is not required
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "disp/window.hpp"
+#include "include/fmt.hpp"
+#include "input/button.hpp"
+#include "input/switchboard.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+// minimum time spent on each measurement
+constexpr auto bench_time = std::chrono::milliseconds(500);
+
+// size of each button, and the gap between them
+constexpr int button_size = 16;
+constexpr int button_step = 20;
+
+// runs fn repeatedly, returning the rate of events_per_run per second
+template <typename F>
+double measure(uint64_t events_per_run, F&& fn)
+{
+	uint64_t runs = 0;
+	auto start = bench_clock::now();
+	auto elapsed = bench_clock::duration::zero();
+	do {
+		fn();
+		++runs;
+		elapsed = bench_clock::now() - start;
+	} while(elapsed < bench_time);
+
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	return double(events_per_run) * runs / seconds;
+}
+
+sf::Event mouse_event(sf::Event::EventType type, int x, int y)
+{
+	sf::Event e;
+	e.type = type;
+	e.mouseButton.button = sf::Mouse::Left;
+	e.mouseButton.x = x;
+	e.mouseButton.y = y;
+	return e;
+}
+
+sf::Event move_event(int x, int y)
+{
+	sf::Event e;
+	e.type = sf::Event::MouseMoved;
+	e.mouseMove.x = x;
+	e.mouseMove.y = y;
+	return e;
+}
+
+int main(int argc, char** argv)
+{
+	int side = argc > 1 ? std::atoi(argv[1]) : 64;
+	if(side <= 0) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "invalid button count");
+		return 1;
+	}
+	stdwindow::winsize = vec2i(side * button_step, side * button_step);
+	button::require_focus = false;
+
+	// press and release in the middle of every button, and move over it and into the gap after it
+	std::vector<sf::Event> events;
+	std::vector<sf::Event> moves;
+	for(int y = 0; y < side; ++y) {
+		for(int x = 0; x < side; ++x) {
+			int px = x * button_step + button_size / 2;
+			int py = y * button_step + button_size / 2;
+			events.push_back(mouse_event(sf::Event::MouseButtonPressed, px, py));
+			events.push_back(mouse_event(sf::Event::MouseButtonReleased, px, py));
+			moves.push_back(move_event(px, py));
+			moves.push_back(move_event(x * button_step + button_size, py));
+		}
+	}
+
+	uint64_t triggered = 0;
+
+	// every state, and back to idle
+	button single(vec2i(0, 0), vec2i(button_size, button_size));
+	const button::state cycle[] = {
+		button::state::hover, button::state::active, button::state::persist,
+		button::state::idle, button::state::persist, button::state::hover,
+		button::state::idle, button::state::active, button::state::idle,
+	};
+	auto transition_rate = measure(sizeof(cycle) / sizeof(*cycle), [&] {
+			for(auto to : cycle) {
+				triggered += single.transition(to).size();
+			}
+		});
+
+	// each button given only its own events
+	std::vector<button> buttons;
+	for(int y = 0; y < side; ++y) {
+		for(int x = 0; x < side; ++x) {
+			buttons.emplace_back(vec2i(x * button_step, y * button_step), vec2i(button_size, button_size));
+		}
+	}
+	auto direct_rate = measure(events.size(), [&] {
+			for(size_t i = 0; i < events.size(); ++i) {
+				triggered += buttons[i / 2].process(events[i]).size();
+			}
+		});
+	auto direct_move_rate = measure(moves.size(), [&] {
+			for(size_t i = 0; i < moves.size(); ++i) {
+				triggered += buttons[i / 2].process(moves[i]).size();
+			}
+		});
+
+	// every button given a sample of the events, as without a switchboard
+	size_t sample = std::min<size_t>(events.size(), 64);
+	auto broadcast_rate = measure(sample, [&] {
+			for(size_t i = 0; i < sample; ++i) {
+				for(auto& b : buttons) {
+					triggered += b.process(events[i]).size();
+				}
+			}
+		});
+	auto broadcast_move_rate = measure(sample, [&] {
+			for(size_t i = 0; i < sample; ++i) {
+				for(auto& b : buttons) {
+					triggered += b.process(moves[i]).size();
+				}
+			}
+		});
+
+	switchboard board({0, 0, stdwindow::winsize.x, stdwindow::winsize.y});
+	for(int y = 0; y < side; ++y) {
+		for(int x = 0; x < side; ++x) {
+			board.add({x * button_step, y * button_step, button_size, button_size});
+		}
+	}
+	board.on_change.connect([&] (const std::vector<switchboard::change>& changes) {
+			triggered += changes.size();
+		});
+	auto board_rate = measure(events.size(), [&] {
+			for(auto& e : events) {
+				board.process(e);
+			}
+			board.dispatch();
+		});
+	auto board_move_rate = measure(moves.size(), [&] {
+			for(auto& e : moves) {
+				board.process(e);
+			}
+			board.dispatch();
+		});
+
+	fmt::print("{} buttons, {} button events triggered\n", side * side, triggered);
+	fmt::print("{:<24} {:>14.0f}\n", "transitions/s", transition_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "direct events/s", direct_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "broadcast events/s", broadcast_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "switchboard events/s", board_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "direct moves/s", direct_move_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "broadcast moves/s", broadcast_move_rate);
+	fmt::print("{:<24} {:>14.0f}\n", "switchboard moves/s", board_move_rate);
+}
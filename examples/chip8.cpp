@@ -10,14 +10,18 @@
 #include <iostream>
 
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 
-#include <sfml/Graphics/RectangleShape.hpp>
+#include <sfml/graphics/renderwindow.hpp>
 
 #include "include/vector.hpp"
 #include "include/randutils.hpp"
 #include "include/fmt.hpp"
 #include "input/keystate.hpp"
+#include "input/sampler.hpp"
+#include "disp/damage_tracker.hpp"
+#include "disp/quad_batch.hpp"
 
 std::array<keystate, 16> keybinds { {
 	sf::Keyboard::X,
@@ -114,6 +118,9 @@ public: // variables
 
 	std::bitset<64 * 32> disp;
 	bool update_disp;
+	std::bitset<64 * 32> drawn; // display as last drawn
+	::disp::damage_tracker canvas;
+	::disp::quad_batch pixels; // kept to reuse its storage
 
 	std::array<uint8_t, 16> V;
 	uint16_t ip; // instruction pointer
@@ -149,7 +156,9 @@ public: // methods
 		stack.clear(); // clear stack
 
 		disp.reset(); // clear display
+		drawn.reset();
 		update_disp = false;
+		canvas.damage_all();
 
 		keys.reset(); // clear keys
 		key_stalling = false;
@@ -521,22 +530,45 @@ public: // methods
 		}
 		update_disp = false;
 
-		stdwin->clear(sf::Color::Black);
-
 		vec2 pixel_size = stdwin.winsize / vec2{ 64, 32 };
 
-		sf::RectangleShape pixel(pixel_size);
-		pixel.setFillColor(sf::Color::White);
-
-		for(int y = 0; y < 32; ++y) {
-			for(int x = 0; x < 64; ++x) {
-				if(disp.test(x + y * 64)) {
-					pixel.setPosition(vec2{x, y} * pixel_size);
-					stdwin->draw(pixel);
+		// only redraw the pixels which changed since the last draw
+		if(rt::opt::a) {
+			canvas.damage_all();
+		} else {
+			auto changed = disp ^ drawn;
+			for(int y = 0; y < 32; ++y) {
+				for(int x = 0; x < 64; ++x) {
+					if(changed.test(x + y * 64)) {
+						vec2 pos = vec2{x, y} * pixel_size;
+						canvas.damage(sf::FloatRect(pos.x, pos.y, pixel_size.x, pixel_size.y));
+					}
 				}
 			}
 		}
-		stdwin->display();
+		drawn = disp;
+
+		canvas.redraw([&] (sf::RenderTarget& target, const sf::FloatRect& clip) {
+				// pixels in the clip rectangle
+				int x0 = std::max(0, int(clip.left / pixel_size.x));
+				int y0 = std::max(0, int(clip.top / pixel_size.y));
+				int x1 = std::min(64, int(std::ceil((clip.left + clip.width) / pixel_size.x)));
+				int y1 = std::min(32, int(std::ceil((clip.top + clip.height) / pixel_size.y)));
+
+				pixels.clear();
+				for(int y = y0; y < y1; ++y) {
+					for(int x = x0; x < x1; ++x) {
+						if(disp.test(x + y * 64)) {
+							vec2 pos = vec2{x, y} * pixel_size;
+							pixels.add(sf::FloatRect(pos.x, pos.y, pixel_size.x, pixel_size.y), sf::Color::White);
+						}
+					}
+				}
+				target.draw(pixels);
+			});
+
+		canvas.present(*stdwin);
+		stdwin.display();
 	}
 
 	void breakpoint() const
@@ -552,6 +584,20 @@ public: // methods
 		}
 	}
 
+	// applies a sampled key event, as update_keys and update_keywait do
+	void apply_key(const sf::Event& e)
+	{
+		bool down = e.type == sf::Event::KeyPressed;
+		for(int i = 0; i < 16; ++i) {
+			if(keybinds[i].get_key() == e.key.code) {
+				keys.set(i, down);
+			}
+		}
+		if(down) {
+			this->update_keywait(e.key.code);
+		}
+	}
+
 	void update_keywait(sf::Keyboard::Key key)
 	{
 		if(!key_stalling) {
@@ -570,6 +616,24 @@ public: // methods
 namespace var {
 	chip8 vm;
 	int hz = 20;
+
+	// sampled input not due yet, and when the last frame's steps ended
+	input::timed_event next_input;
+	bool has_next_input = false;
+	rt::clock::time_point last_step;
+}
+
+// applies sampled key changes which happened up to a point in time
+void apply_input(rt::clock::time_point until)
+{
+	while(var::has_next_input || input::background_sampler.pop(var::next_input)) {
+		if(var::next_input.time > until) {
+			var::has_next_input = true;
+			return;
+		}
+		var::has_next_input = false;
+		var::vm.apply_key(var::next_input.event);
+	}
 }
 
 void initial()
@@ -593,32 +657,67 @@ void initial()
 		rom.push_back(byte);
 	}
 
+	var::vm.canvas.create(stdwin.winsize.x, stdwin.winsize.y);
 	var::vm.init();
 
 	if(rt::opt::c) {
 		var::hz = std::stoi(*rt::opt::c);
 	}
 
+	// with --input-rate, keys are sampled on a thread instead of once per frame
+	for(auto& bind : keybinds) {
+		input::background_sampler.watch(bind.get_key());
+	}
+	var::last_step = rt::clock::now();
+
 	rt::on_frame.connect([] {
 			try {
-				var::vm.update_keys();
+				bool sampled = input::background_sampler.is_running();
+				if(!sampled) {
+					var::vm.update_keys();
+				}
 				if(rt::opt::b) {
 					var::vm.dump();
 					var::vm.breakpoint();
 				}
-				var::vm.step();
-				for(int i = 0; i < var::hz - 1 ; ++i) {
+				if(sampled) {
+					// spread the steps over the time since the last frame, each
+					// seeing the key changes from before its time
+					auto now = rt::clock::now();
+					auto span = now - var::last_step;
+					for(int i = 0; i < var::hz; ++i) {
+						apply_input(var::last_step + span * (i + 1) / var::hz);
+						var::vm.step();
+					}
+					var::last_step = now;
+				} else {
 					var::vm.step();
+					for(int i = 0; i < var::hz - 1 ; ++i) {
+						var::vm.step();
+					}
 				}
 				var::vm.draw();
+
+				// nothing changes while waiting for a key, so only a key press needs a frame
+				if(!var::vm.key_stalling) {
+					rt::redraw();
+				}
 			} catch(...) {
 				var::vm.dump();
 				throw;
 			}
 		});
 
-	rt::on_win_event.connect([] (const sf::Event& e) {
-			if(e.type == sf::Event::KeyPressed) {
+	rt::on_cleanup.connect([] {
+			auto stats = var::vm.canvas.get_stats();
+			if(stats.frames > 0) {
+				fmt::print(logstream(), "redrawn {:.1f}% of the display per frame\n",
+				           100.0 * stats.total_area / (stats.frames * stats.canvas_area));
+			}
+		});
+
+	rt::on_event[sf::Event::KeyPressed].connect([] (const sf::Event& e) {
+			if(!input::background_sampler.is_running()) {
 				var::vm.update_keywait(e.key.code);
 			}
 		});
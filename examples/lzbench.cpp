@@ -0,0 +1,121 @@
+// compares decompression throughput of res::lz_decompress against reading the
+// raw bytes of a file
+// argv: [files...]
+//
+// without files, the resources in res1 are measured instead; res1 is a lazy
+// resource library, so the time taken to load it on first use is printed too
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "include/fmt.hpp"
+#include "res/lz.hpp"
+#include "res/memfile.hpp"
+#include "res1.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+// minimum time spent on each measurement
+constexpr auto bench_time = std::chrono::milliseconds(500);
+
+// runs fn repeatedly, returning throughput in MiB/s of bytes_per_run
+template <typename F>
+double measure(uint64_t bytes_per_run, F&& fn)
+{
+	uint64_t runs = 0;
+	auto start = bench_clock::now();
+	auto elapsed = bench_clock::duration::zero();
+	do {
+		fn();
+		++runs;
+		elapsed = bench_clock::now() - start;
+	} while(elapsed < bench_time);
+
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	return double(bytes_per_run) * runs / seconds / (1 << 20);
+}
+
+// prints a row of the table, returning false if the round trip fails
+bool bench(const char* pgname, const char* name, const uint8_t* raw, uint64_t size)
+{
+	auto packed = res::lz_compress(raw, size);
+	std::vector<uint8_t> out(size);
+
+	// reading the raw bytes is a copy out of the mapping
+	auto read_rate = measure(size, [&] {
+			std::memcpy(out.data(), raw, size);
+		});
+
+	bool ok = true;
+	auto unlz_rate = measure(size, [&] {
+			ok = ok && res::lz_decompress(packed.data(), packed.size(), out.data(), out.size());
+		});
+	if(!ok || std::memcmp(out.data(), raw, size) != 0) {
+		fmt::print(std::cerr, "{}: {}: {}\n", pgname, name, "round trip failed");
+		return false;
+	}
+
+	fmt::print("{:<24} {:>10} {:>10} {:>7.3f} {:>12.1f} {:>12.1f}\n",
+		name, size, packed.size(), double(packed.size()) / size,
+		read_rate, unlz_rate);
+	return true;
+}
+
+// measures the blocks in res1, which is loaded by the first access
+int bench_lazy(const char* pgname)
+{
+	const std::pair<const char*, const res::lazy_memblk*> blocks[] = {
+		{ "knight.png", &store::knight_png },
+		{ "rocket.png", &store::rocket_png },
+		{ "test.png", &store::test_png },
+		{ "monofonto.ttf", &store::monofonto_ttf },
+	};
+
+	try {
+		auto start = bench_clock::now();
+		blocks[0].second->get();
+		auto load_time = std::chrono::duration<double, std::milli>(bench_clock::now() - start);
+		fmt::print("res1 loaded in {:.3f} ms\n\n", load_time.count());
+	} catch(std::exception& e) {
+		fmt::print(std::cerr, "{}: {}\n", pgname, e.what());
+		return 1;
+	}
+
+	fmt::print("{:<24} {:>10} {:>10} {:>7} {:>12} {:>12}\n",
+		"block", "raw", "packed", "ratio", "read MiB/s", "unlz MiB/s");
+
+	for(auto& block : blocks) {
+		auto raw = static_cast<const uint8_t*>(block.second->get());
+		if(!bench(pgname, block.first, raw, block.second->size())) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc <= 1) {
+		return bench_lazy(argv[0]);
+	}
+
+	fmt::print("{:<24} {:>10} {:>10} {:>7} {:>12} {:>12}\n",
+		"file", "raw", "packed", "ratio", "read MiB/s", "unlz MiB/s");
+
+	for(int i = 1; i < argc; ++i) {
+		res::ro_memfile file;
+		std::error_code ec;
+		if(!file.open(argv[i], ec)) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[i], ec.message());
+			return 1;
+		}
+
+		if(!bench(argv[0], argv[i], static_cast<const uint8_t*>(file.get()), file.size())) {
+			return 1;
+		}
+	}
+}
@@ -5,6 +5,13 @@
 #include "include/fmt.hpp"
 #include "include/entityx.hpp"
 #include "res0.hpp"
+#include "monofonto_glyphs.hpp"
+#include "sprites.hpp"
+#include "disp/frame_recorder.hpp"
+#include "disp/glyph_text.hpp"
+#include "disp/quad_batch.hpp"
+#include "res/loader.hpp"
+#include "res/prefetch.hpp"
 
 #include <sfml/graphics.hpp>
 
@@ -12,6 +19,7 @@
 #include <numeric>
 #include <cassert>
 #include <deque>
+#include <stdexcept>
 
 randutils::mt19937_rng rng;
 
@@ -268,12 +276,43 @@ namespace var {
 	sf::Clock clock;
 	std::deque<double> past_ticks;
 
-	sf::Font monofonto;
-	sf::Text fps_counter;
-	sf::Text score;
+	res::prefetch warmup;
+	res::loader loader;
+	sf::Texture glyph_atlas;
+	sf::Texture sprite_atlas;
+	disp::quad_batch sprite_strip;
+	disp::glyph_text fps_counter;
+	disp::glyph_text score;
+
+	disp::frame_recorder recorder;
 
 } // namespace var
 
+// a row of the packed sprites along the bottom, drawn from the atlas in one draw
+void build_sprite_strip()
+{
+	const res::atlas_rect sprites[] = {
+		store::sprites::knight_png, store::sprites::rocket_png, store::sprites::test_png
+	};
+	const float height = 24;
+	const float gap = 8;
+
+	float width = 0;
+	for(auto& r : sprites) {
+		width += height * r.width / r.height + gap;
+	}
+
+	float x = (stdwin.winsize.x - width + gap) / 2;
+	float y = stdwin.winsize.y - 10 - height;
+	var::sprite_strip.clear();
+	for(auto& r : sprites) {
+		float w = height * r.width / r.height;
+		var::sprite_strip.add(sf::FloatRect(x, y, w, height), var::sprite_atlas,
+		                      sf::FloatRect(r.left, r.top, r.width, r.height));
+		x += w + gap;
+	}
+}
+
 double get_fps()
 {
 	double tick_sum = std::accumulate(var::past_ticks.begin(), var::past_ticks.end(), 0.0);
@@ -297,54 +336,112 @@ void start_ball()
 	}
 }
 
-void events(const sf::Event& e)
+void key_pressed(const sf::Event& e)
 {
-	if(e.type == sf::Event::KeyPressed) {
-		if(e.key.code == sf::Keyboard::Space) {
-			start_ball();
-		}
+	if(e.key.code == sf::Keyboard::Space) {
+		start_ball();
 	}
 }
 
 void initial()
 {
+	// fault in what the first frames need while the window is created
+	var::warmup.add(store::monofonto_glyphs_png);
+	var::warmup.add(store::sprites_0_png);
+	var::warmup.start();
+
 	cfg::tick_window = stdwin.winfps < 1 ? 200 : stdwin.winfps / 2;
 
+	// a: record the session to a file
+	if(rt::opt::a && !var::recorder.open(*rt::opt::a)) {
+		fmt::print("{}: {}: cannot open\n", rt::pgname, *rt::opt::a);
+		rt::exit(1);
+	}
+
 	rt::on_frame.connect([] {
+			var::loader.poll();
+
 			auto elapsed = var::clock.restart();
 			var::past_ticks.push_front(elapsed.asSeconds());
 			if(var::past_ticks.size() > cfg::tick_window) {
 				var::past_ticks.pop_back();
 			}
 
-			var::fps_counter.setString(std::to_string(int(get_fps())).c_str());
-			var::score.setString(fmt::format("{:>3} : {:<3}", var::left_score, var::right_score).c_str());
-			var::score.setPosition((stdwin.winsize.x - var::score.getLocalBounds().width) / 2, 20);
+			var::fps_counter.set_string(std::to_string(int(get_fps())));
+			var::score.set_string(fmt::format("{:>3} : {:<3}", var::left_score, var::right_score));
+			var::score.setPosition((stdwin.winsize.x - var::score.local_bounds().width) / 2, 20);
 		}, 0);
 	rt::on_frame.connect([] {
 			stdwin->clear(sf::Color::Black);
 
 			stdwin->draw(var::score);
 			var::world.update(var::past_ticks.front());
+			stdwin->draw(var::sprite_strip);
 			stdwin->draw(var::fps_counter);
 
-			stdwin->display();
+			var::recorder.push(*stdwin);
+			stdwin.display();
+
+			// always animated, so keep drawing with -d
+			rt::redraw();
 		}, 30);
-	rt::on_win_event.connect(events);
+	rt::on_event[sf::Event::KeyPressed].connect(key_pressed);
+	rt::on_cleanup.connect([] {
+			// l: alongside the latency report
+			if(rt::opt::latency) {
+				auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(rt::first_frame_time);
+				fmt::print("first frame after {} ms\n", ms.count());
+			}
 
-	if(!var::monofonto.loadFromMemory(store::monofonto_ttf.get(), store::monofonto_ttf.size())) {
-		std::cout << "load err: monofonto.ttf";
-		rt::exit(1);
-	}
+			if(var::recorder.is_open()) {
+				var::recorder.close();
+				auto stats = var::recorder.get_stats();
+				fmt::print("recorded {} frames ({} bytes), dropped {}, failed {}\n", stats.written, stats.bytes, stats.dropped, stats.failed);
+			}
+		});
+
+	// decode in the background, text appears once the texture is made
+	var::loader.load_block(store::monofonto_glyphs_png.get(), store::monofonto_glyphs_png.size(),
+		[] (const void* addr, uint64_t size) {
+			sf::Image image;
+			if(!image.loadFromMemory(addr, size)) {
+				throw std::runtime_error("load err: monofonto_glyphs.png");
+			}
+			return image;
+		},
+		[] (std::future<sf::Image> image) {
+			try {
+				var::glyph_atlas.loadFromImage(image.get());
+			} catch(const std::exception& e) {
+				fmt::print(std::cerr, "{}: {}\n", rt::pgname, e.what());
+				rt::exit(1);
+			}
+		});
+
+	var::loader.load_block(store::sprites_0_png.get(), store::sprites_0_png.size(),
+		[] (const void* addr, uint64_t size) {
+			sf::Image image;
+			if(!image.loadFromMemory(addr, size)) {
+				throw std::runtime_error("load err: sprites_0.png");
+			}
+			return image;
+		},
+		[] (std::future<sf::Image> image) {
+			try {
+				var::sprite_atlas.loadFromImage(image.get());
+				build_sprite_strip();
+			} catch(const std::exception& e) {
+				fmt::print(std::cerr, "{}: {}\n", rt::pgname, e.what());
+				rt::exit(1);
+			}
+		});
 
-	var::fps_counter.setPosition(10, stdwin.winsize.y - 10 - var::monofonto.getLineSpacing(16));
-	var::fps_counter.setFont(var::monofonto);
-	var::fps_counter.setCharacterSize(16);
-	var::fps_counter.setFillColor(sf::Color{100, 100, 100});
+	var::fps_counter.set_glyphs(store::monofonto_glyphs::size_16, var::glyph_atlas);
+	var::fps_counter.setPosition(10, stdwin.winsize.y - 10 - var::fps_counter.line_spacing());
+	var::fps_counter.set_colour(sf::Color{100, 100, 100});
 
-	var::score.setFont(var::monofonto);
-	var::score.setCharacterSize(30);
-	var::score.setFillColor(sf::Color::White);
+	var::score.set_glyphs(store::monofonto_glyphs::size_30, var::glyph_atlas);
+	var::score.set_colour(sf::Color::White);
 
 	var::world.load();
 	var::clock.restart();
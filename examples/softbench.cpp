@@ -0,0 +1,146 @@
+// renders a scene of quads, lines and text with disp::soft_target, without a
+// window or GPU, and measures frames per second with one thread and with a
+// thread per core
+// argv: [reference image]
+//
+// with a reference image, the first frame is compared against it, and the
+// exit status is 1 if any pixel differs; if the file does not exist, the
+// frame is written to it instead
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <sfml/graphics/image.hpp>
+
+#include "disp/glyph_text.hpp"
+#include "disp/line_batch.hpp"
+#include "disp/quad_batch.hpp"
+#include "disp/soft_target.hpp"
+#include "include/fmt.hpp"
+#include "res0.hpp"
+#include "monofonto_glyphs.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+// minimum time spent on each measurement
+constexpr auto bench_time = std::chrono::milliseconds(500);
+
+constexpr unsigned int frame_width = 640;
+constexpr unsigned int frame_height = 480;
+
+// runs fn repeatedly, returning the runs per second
+template <typename F>
+double measure(F&& fn)
+{
+	uint64_t runs = 0;
+	auto start = bench_clock::now();
+	auto elapsed = bench_clock::duration::zero();
+	do {
+		fn(runs);
+		++runs;
+		elapsed = bench_clock::now() - start;
+	} while(elapsed < bench_time);
+
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	return double(runs) / seconds;
+}
+
+struct scene
+{
+	disp::quad_batch quads;
+	disp::line_batch lines;
+	disp::glyph_text text;
+
+	// the scene is a function of the frame number, so any frame can be reproduced
+	void build(uint64_t frame)
+	{
+		float phase = float(frame % 360) * 3.14159265f / 180;
+
+		quads.clear();
+		for(int y = 0; y < 12; ++y) {
+			for(int x = 0; x < 16; ++x) {
+				float wobble = std::sin(phase + float(x + y) / 4) * 8;
+				sf::Color colour(uint8_t(x * 16), uint8_t(y * 20), uint8_t(255 - x * 8), 192);
+				quads.add(sf::FloatRect(x * 40 + 4 + wobble, y * 40 + 4, 32, 32), colour);
+			}
+		}
+
+		lines.clear();
+		for(int i = 0; i < 32; ++i) {
+			float angle = phase + float(i) * 3.14159265f / 16;
+			sf::Vector2f centre(frame_width / 2.f, frame_height / 2.f);
+			sf::Vector2f tip(centre.x + std::cos(angle) * 200, centre.y + std::sin(angle) * 200);
+			lines.add(centre, tip, 2, sf::Color(255, 255, 255, 160));
+		}
+
+		text.set_string(fmt::format("frame {:>6}", frame));
+	}
+
+	void draw(disp::soft_target& target) const
+	{
+		target.clear(sf::Color(16, 16, 32));
+		target.draw(quads);
+		target.draw(lines);
+		target.draw(text);
+		target.display();
+	}
+};
+
+int main(int argc, char** argv)
+{
+	sf::Image glyph_image;
+	if(!glyph_image.loadFromMemory(store::monofonto_glyphs_png.get(), store::monofonto_glyphs_png.size())) {
+		fmt::print(std::cerr, "{}: {}\n", argv[0], "cannot decode monofonto_glyphs.png");
+		return 1;
+	}
+
+	scene s;
+	s.text.set_glyphs(store::monofonto_glyphs::size_30, glyph_image);
+	s.text.setPosition(20, frame_height - 60);
+
+	unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+	for(unsigned int threads : {1u, cores}) {
+		disp::soft_target target(frame_width, frame_height, threads);
+		auto rate = measure([&] (uint64_t frame) {
+				s.build(frame);
+				s.draw(target);
+			});
+		fmt::print("{:>2} threads {:>10.1f} frames/s\n", threads, rate);
+		if(cores == 1) {
+			break;
+		}
+	}
+
+	if(argc <= 1) {
+		return 0;
+	}
+
+	// the result does not depend on the number of threads
+	disp::soft_target target(frame_width, frame_height);
+	s.build(0);
+	s.draw(target);
+	auto frame = target.capture();
+
+	if(!std::ifstream(argv[1])) {
+		if(!frame.saveToFile(argv[1])) {
+			fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], "cannot write");
+			return 1;
+		}
+		fmt::print("{}: written\n", argv[1]);
+		return 0;
+	}
+
+	sf::Image reference;
+	if(!reference.loadFromFile(argv[1])) {
+		fmt::print(std::cerr, "{}: {}: {}\n", argv[0], argv[1], "cannot read");
+		return 1;
+	}
+	auto differing = disp::soft_target::difference(frame, reference);
+	fmt::print("{}: {} pixels differ\n", argv[1], differing);
+	return differing == 0 ? 0 : 1;
+}
@@ -1,6 +1,10 @@
 #include "core/runtime.cpp"
 #include "include/randutils.hpp"
 #include "res0.hpp"
+#include "monofonto_glyphs.hpp"
+#include "disp/glyph_text.hpp"
+#include "disp/quad_batch.hpp"
+#include "res/cache.hpp"
 
 #include <sfml/graphics.hpp>
 
@@ -12,6 +16,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <stdexcept>
 #include <variant>
 
 constexpr int data_size = 3000;
@@ -114,8 +119,31 @@ namespace central {
 		compare_count = 0;
 	}
 
-	sf::Font proggy_clean;
-	sf::Text header;
+	// decoded resources, in the memory budget shared with decompressed blocks
+	res::cache<sf::Image> images([] (const void* addr, uint64_t size) {
+			sf::Image image;
+			if(!image.loadFromMemory(addr, size_t(size))) {
+				throw std::runtime_error("cannot decode image");
+			}
+			return image;
+		}, [] (const sf::Image& image, uint64_t) {
+			return uint64_t(image.getSize().x) * image.getSize().y * 4;
+		});
+	res::cache<sf::Texture> textures([] (const void* addr, uint64_t size) {
+			sf::Texture texture;
+			if(!texture.loadFromMemory(addr, size_t(size))) {
+				throw std::runtime_error("cannot decode texture");
+			}
+			return texture;
+		}, [] (const sf::Texture& texture, uint64_t) {
+			return uint64_t(texture.getSize().x) * texture.getSize().y * 4;
+		});
+
+	// held while the header draws from them
+	// the image is drawn from directly when headless, where no texture can be made
+	res::cache<sf::Image>::value_ptr glyph_image;
+	res::cache<sf::Texture>::value_ptr glyph_texture;
+	disp::glyph_text header;
 
 	namespace thread { // {{{
 
@@ -328,13 +356,12 @@ namespace central {
 			}
 		}
 
-		stdwin->clear(sf::Color::Black);
+		// bars are drawn up from the bottom of the window
+		static disp::quad_batch bars;
+		bars.clear();
+		float bottom = static_cast<float>(stdwin.winsize.y);
+		double x = 0;
 
-		sf::RectangleShape rect;
-		rect.setOrigin(static_cast<float>(0), static_cast<float>(stdwin.winsize.y));
-		rect.setScale(1, -1);
-
-		rect.setPosition(0, 0);
 		double height_step = (stdwin.winsize.y - 30) / double(data_max);
 		double width_step = stdwin.winsize.x / double(data_size);
 		double width = width_step - 0;
@@ -354,8 +381,7 @@ namespace central {
 			int i = static_cast<int>(counter);
 
 			for(auto& elem : thread::data) {
-				rect.setSize(sf::Vector2f(static_cast<float>(width), static_cast<float>(elem.value * height_step)));
-				// rect.setPosition(rect.getPosition().x, -elem.value * height_step);
+				auto height = static_cast<float>(elem.value * height_step);
 				auto color = sf::Color::White;
 
 				if(elem.hi_mode) {
@@ -366,29 +392,44 @@ namespace central {
 					--i;
 				}
 
-				rect.setFillColor(color);
-
-				stdwin->draw(rect);
-				rect.move(static_cast<float>(width_step), 0);
+				bars.add(sf::FloatRect(static_cast<float>(x), bottom - height, static_cast<float>(width), height), color);
+				x += width_step;
 			}
 		}
 
 		std::string head = (shuffling ? "shuffling..." : get_name(get_current_method())) + " - " + std::to_string(assign_count) + " assignments, " + std::to_string(compare_count) + " comparisons";
 
-		header.setString(head.c_str());
-		stdwin->draw(header);
+		header.set_string(head);
 
-		stdwin->display();
+		// to the window, or to memory with --headless
+		stdwin.render([] (auto& target) {
+				target.clear(sf::Color::Black);
+				target.draw(bars);
+				target.draw(header);
+			});
+		stdwin.display();
+
+		// keep going until the scroll-up effect has covered every bar
+		if(!sort_finished.load() || counter < data_size) {
+			rt::redraw();
+		}
 	}
 
 	void var_init()
 	{
-		if(!proggy_clean.loadFromMemory(store::monofonto_ttf.get(), store::monofonto_ttf.size())) {
+		try {
+			if(stdwindow::headless) {
+				glyph_image = images.get("monofonto_glyphs.png", store::monofonto_glyphs_png);
+				header.set_glyphs(store::monofonto_glyphs::size_16, *glyph_image);
+			} else {
+				glyph_texture = textures.get("monofonto_glyphs.png", store::monofonto_glyphs_png);
+				header.set_glyphs(store::monofonto_glyphs::size_16, *glyph_texture);
+			}
+		} catch(const std::runtime_error& e) {
+			fmt::print(std::cerr, "{}: {}\n", rt::pgname, e.what());
 			rt::exit(1);
 		}
-		header.setFont(proggy_clean);
-		header.setFillColor(sf::Color::White);
-		header.setCharacterSize(16);
+		header.set_colour(sf::Color::White);
 
 		sort_thread = std::thread(thread::initial);
 	}
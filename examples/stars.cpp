@@ -3,11 +3,16 @@
 #include "include/randutils.hpp"
 #include "include/vector.hpp"
 #include "include/entityx.hpp"
+#include "disp/command_buffer.hpp"
+#include "disp/render_thread.hpp"
 
 #include <sfml/graphics.hpp>
 
 randutils::mt19937_rng rng;
 
+// draws frames recorded by render_sys
+disp::render_thread renderer(*stdwin);
+
 namespace cfg {
 
 	double time_scale = 10.0;
@@ -44,28 +49,22 @@ struct move_sys
 struct render_sys
 	: public entityx::System<render_sys>
 {
+	disp::command_buffer stars;
+
 	void update(entityx::EntityManager& es, entityx::EventManager &events, double)
 	{
-		stdwin->clear(sf::Color::Black);
-
-		static sf::RectangleShape shape = [] {
-			sf::RectangleShape r;
-			r.setOrigin(float(-stdwin.winsize.x / 2), float(-stdwin.winsize.y / 2));
-			r.setSize(sf::Vector2f(1, 1));
-			return r;
-		}();
+		// the stars are centred on the window
+		vec2 centre{stdwin.winsize.x / 2.0, stdwin.winsize.y / 2.0};
 
 		es.each<vec3>([&] (entityx::Entity e, vec3& pos) {
 				unsigned char value = static_cast<unsigned char>(255 * cfg::colour_scale / (pos.z + cfg::colour_scale));
-				shape.setFillColor(sf::Color(value, value, value));
 
-				vec2 view_pos = 10 * pos.xy / pos.z;
-				shape.setPosition(view_pos.x, view_pos.y);
-
-				stdwin->draw(shape);
+				vec2 view_pos = centre + 10 * pos.xy / pos.z;
+				stars.add_rect(sf::FloatRect(float(view_pos.x), float(view_pos.y), 1, 1), sf::Color(value, value, value));
 			});
 
-		stdwin->display();
+		// drawn on the render thread, while the next frame is updated
+		stars = renderer.submit(std::move(stars));
 	}
 };
 
@@ -102,9 +101,23 @@ namespace var {
 
 void initial()
 {
+	stdwin.init();
+	renderer.start();
+
+	// the window is closed on the main thread, so stop drawing first
+	rt::on_event[sf::Event::Closed].connect([] (const sf::Event&) {
+			renderer.stop();
+		});
+	rt::on_cleanup.connect([] {
+			renderer.stop();
+		});
+
 	rt::on_frame.connect([] {
 			auto elapsed = var::clock.restart();
 			var::world.update(elapsed.asSeconds());
+
+			// always animated, so keep drawing with -d
+			rt::redraw();
 		});
 
 	var::world.load();
@@ -0,0 +1,93 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * \class spsc_queue
+ * \brief Fixed size lock-free queue, for one producer and one consumer
+ *
+ * One thread may push() while another pops, without locking. The elements
+ * are held in a ring buffer of \p Capacity elements (a power of two), and
+ * push() fails when it is full.
+ *
+ * The indices only ever increase, wrapping around the size_t range, and the
+ * element at an index is found by masking it.
+ */
+template <typename T, size_t Capacity>
+class spsc_queue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "spsc_queue capacity must be a power of two");
+
+public: // statics
+
+	using value_type = T;
+	using size_type = size_t;
+
+	static constexpr size_type capacity = Capacity;
+
+private: // internal statics
+
+	static constexpr size_type mask = Capacity - 1;
+
+	// keeps the indices on separate cache lines, so the threads don't contend
+	static constexpr size_t line_size = 64;
+
+private: // variables
+
+	std::array<T, Capacity> items;
+
+	// written by the consumer
+	alignas(line_size) std::atomic<size_type> head;
+	// written by the producer
+	alignas(line_size) std::atomic<size_type> tail;
+
+public: // methods
+
+	spsc_queue()
+		: items()
+		, head(0)
+		, tail(0)
+	{
+	}
+
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	/// Add an element, on the producer thread. Returns false if full
+	bool push(const T& value)
+	{
+		auto back = tail.load(std::memory_order_relaxed);
+		if(back - head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		items[back & mask] = value;
+		tail.store(back + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Take the oldest element, on the consumer thread. Returns false if empty
+	bool pop(T& out)
+	{
+		auto front = head.load(std::memory_order_relaxed);
+		if(front == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		out = items[front & mask];
+		head.store(front + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Number of elements, which may already be out of date on either thread
+	size_type size() const
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	bool empty() const
+	{
+		return this->size() == 0;
+	}
+};
@@ -4,8 +4,45 @@
 
 #include <cassert>
 
+namespace { // anonymous
+
+	using state = button::state;
+	using event = button::event;
+
+	// events triggered by each transition, indexed by the states from and to
+	constexpr button::event_list transitions[4][4] = {
+		/* from idle */ {
+			/* to idle    */ { /* none */                                  },
+			/* to hover   */ { event::hover_on                             },
+			/* to active  */ { event::hover_on, event::press               },
+			/* to persist */ { event::hover_on, event::press, event::leave },
+		},
+		/* from hover */ {
+			/* to idle    */ { event::hover_off                            },
+			/* to hover   */ { /* none */                                  },
+			/* to active  */ { event::press                                },
+			/* to persist */ { event::press, event::leave                  },
+		},
+		/* from active */ {
+			/* to idle    */ { event::leave, event::away_release           },
+			/* to hover   */ { event::release                              },
+			/* to active  */ { /* none */                                  },
+			/* to persist */ { event::leave                                },
+		},
+		/* from persist */ {
+			/* to idle    */ { event::away_release                         },
+			/* to hover   */ { event::reenter, event::release              },
+			/* to active  */ { event::reenter                              },
+			/* to persist */ { /* none */                                  },
+		},
+	};
+
+} // namespace anonymous
+
 // class button {{{
 
+bool button::require_focus = true;
+
 button::button()
 	: bound()
 	, condition(state::idle)
@@ -39,44 +76,23 @@ sf::Rect<button::dimension_type> button::region() const
 	return bound;
 }
 
-std::list<button::event> button::region(sf::Rect<dimension_type> new_bound)
+button::event_list button::region(sf::Rect<dimension_type> new_bound)
 {
 	bound = new_bound;
 	return this->transition(state::idle);
 }
 
-std::list<button::event> button::transition(state new_state)
+button::event_list button::transition(state new_state)
 {
-	using event_table = std::map<std::pair<state, state>, std::list<button::event>>;
-	static const event_table transitions = {
-		/*   state from      state to           triggered events */
-		{ { state::idle,    state::idle    }, { /* none*/                                   } },
-		{ { state::idle,    state::hover   }, { event::hover_on                             } },
-		{ { state::idle,    state::active  }, { event::hover_on, event::press               } },
-		{ { state::idle,    state::persist }, { event::hover_on, event::press, event::leave } },
-		{ { state::hover,   state::idle    }, { event::hover_off                            } },
-		{ { state::hover,   state::hover   }, { /* none*/                                   } },
-		{ { state::hover,   state::active  }, { event::press                                } },
-		{ { state::hover,   state::persist }, { event::press, event::leave                  } },
-		{ { state::active,  state::idle    }, { event::leave, event::away_release           } },
-		{ { state::active,  state::hover   }, { event::release                              } },
-		{ { state::active,  state::active  }, { /* none*/                                   } },
-		{ { state::active,  state::persist }, { event::leave                                } },
-		{ { state::persist, state::idle    }, { event::away_release                         } },
-		{ { state::persist, state::hover   }, { event::reenter, event::release              } },
-		{ { state::persist, state::active  }, { event::reenter                              } },
-		{ { state::persist, state::persist }, { /* none*/                                   } }
-	};
-
-	auto change_pair = std::make_pair(condition, new_state);
-	auto events = transitions.find(change_pair);
-	assert(events != transitions.end() && "Transition not valid, invalid enum values?");
+	auto from = size_t(condition);
+	auto to = size_t(new_state);
+	assert(from < 4 && to < 4 && "Transition not valid, invalid enum values?");
 
 	condition = new_state;
-	return events->second;
+	return transitions[from][to];
 }
 
-std::list<button::event> button::process(const sf::Event& e)
+button::event_list button::process(const sf::Event& e)
 { // {{{
 	/*
 	 * possible transition are displayed in a diagram
@@ -98,7 +114,7 @@ std::list<button::event> button::process(const sf::Event& e)
 		 * O <> O
 		 */
 		// only trigger if has focus
-		if(!stdwin->hasFocus()) {
+		if(require_focus && !stdwin->hasFocus()) {
 			return {};
 		}
 
@@ -147,7 +163,7 @@ std::list<button::event> button::process(const sf::Event& e)
 		bool wincontained = winarea.contains(pos);
 		bool contained = wincontained && this->contains(pos);
 
-		std::list<event> out;
+		event_list out;
 
 		if(condition == state::persist && contained) {
 			out = this->transition(state::active);
@@ -156,11 +172,9 @@ std::list<button::event> button::process(const sf::Event& e)
 		}
 
 		if(condition == state::persist) {
-			auto steps = this->transition(state::idle);
-			out.splice(out.end(), std::move(steps));
+			out.append(this->transition(state::idle));
 		} else if(condition == state::active) {
-			auto steps = this->transition(state::hover);
-			out.splice(out.end(), std::move(steps));
+			out.append(this->transition(state::hover));
 		}
 		return out;
 	} else if(e.type == sf::Event::LostFocus) {
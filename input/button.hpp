@@ -1,8 +1,9 @@
 /* -*- cpp.doxygen -*- */
 #pragma once
 
-#include <map>
-#include <list>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
 
 #include <sfml/graphics/rect.hpp>
 #include <sfml/window/event.hpp>
@@ -25,6 +26,12 @@ class button
 public: // statics
 
 	using dimension_type = int;
+
+	/**
+	 * MouseMoved is ignored unless the window has focus. This can be
+	 * turned off to process events without a window, e.g. in benchmarks.
+	 */
+	static bool require_focus;
 	using vector_type = vector<int, 2>;
 
 	/*
@@ -53,6 +60,59 @@ public: // statics
 		// cannot happen: away_press, // idle -> persist
 	};
 
+	/*
+	 * A transition triggers at most 3 events (idle -> persist), and an event
+	 * causes at most 2 transitions, so the events fit in a small list held
+	 * inline, without allocating on every mouse event.
+	 */
+	class event_list
+	{
+	public: // statics
+
+		static constexpr size_t capacity = 4;
+
+	private: // variables
+
+		event events[capacity];
+		size_t count;
+
+	public: // methods
+
+		constexpr event_list()
+			: events()
+			, count(0)
+		{
+		}
+
+		constexpr event_list(std::initializer_list<event> init)
+			: events()
+			, count(0)
+		{
+			for(auto e : init) {
+				events[count++] = e;
+			}
+		}
+
+		void push_back(event e)
+		{
+			assert(count < capacity && "Too many events for event_list");
+			events[count++] = e;
+		}
+
+		void append(const event_list& other)
+		{
+			for(auto e : other) {
+				this->push_back(e);
+			}
+		}
+
+		const event* begin() const { return events; }
+		const event* end() const { return events + count; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		event operator[](size_t i) const { return events[i]; }
+	};
+
 	/*
 	 * Since the two variables (press and proximity) are controlled by separate events:
 	 * MouseMoved for proximity and MouseButtonPressed and
@@ -76,8 +136,8 @@ public: // methods
 	state current_state() const;
 	sf::Rect<dimension_type> region() const;
 	// Note: This automatically sets the state to idle
-	std::list<event> region(sf::Rect<dimension_type> new_bound);
+	event_list region(sf::Rect<dimension_type> new_bound);
 
-	std::list<event> transition(state new_state);
-	std::list<event> process(const sf::Event& e);
+	event_list transition(state new_state);
+	event_list process(const sf::Event& e);
 };
@@ -19,7 +19,17 @@ void keystate::rebind(key_type kcode)
 
 bool keystate::pressed() const
 {
-	return sf::Keyboard::isKeyPressed(key);
+	return input::frame_keys.pressed(key);
+}
+
+bool keystate::just_pressed() const
+{
+	return input::frame_keys.just_pressed(key);
+}
+
+bool keystate::just_released() const
+{
+	return input::frame_keys.just_released(key);
 }
 
 keystate::operator bool() const
@@ -3,12 +3,15 @@
 
 #include <sfml/window/keyboard.hpp>
 
+#include "input/snapshot.hpp"
+
 /**
  * \class keystate
  * \brief Rebindable key state accessor
  *
- * This is a wrapper around sf::Keyboard::isKeyPressed for a bound key. Member
- * functions are provided to simplify code.
+ * This reads the state of a bound key from input::frame_keys, the snapshot
+ * of the keyboard the runtime keeps for each frame. Member functions are
+ * provided to simplify code.
  *
  * The main addition of this is that it stores the key being tested. This
  * abstracts away the key, allowing key-independent controls.
@@ -31,6 +34,8 @@ public: // methods
 	void rebind(key_type kcode = key_type::Unknown);
 
 	bool pressed() const;
+	bool just_pressed() const;
+	bool just_released() const;
 	explicit operator bool() const;
 	bool operator!() const;
 
@@ -0,0 +1,216 @@
+#include "sampler.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace { // anonymous
+
+	// modifiers are not sampled, they can be watched as keys instead
+	sf::Event key_event(sf::Keyboard::Key key, bool down)
+	{
+		sf::Event event;
+		event.type = down ? sf::Event::KeyPressed : sf::Event::KeyReleased;
+		event.key.code = key;
+		event.key.alt = false;
+		event.key.control = false;
+		event.key.shift = false;
+		event.key.system = false;
+		return event;
+	}
+
+} // namespace anonymous
+
+namespace input {
+
+	sampler background_sampler;
+
+	// class sampler {{{
+
+	sampler::sampler()
+		: window(nullptr)
+		, interval(clock::duration::zero())
+		, thread()
+		, running(false)
+		, focused(true)
+		, keys()
+		, mouse(false)
+		, queue()
+		, keys_down()
+		, buttons_down()
+		, mouse_pos()
+		, samples(0)
+		, events(0)
+		, dropped(0)
+	{
+	}
+
+	sampler::~sampler()
+	{
+		this->stop();
+	}
+
+	void sampler::watch(key_type key)
+	{
+		assert(!this->is_running() && "Keys must be watched before starting the sampler");
+		if(key >= 0 && key < sf::Keyboard::KeyCount && std::find(keys.begin(), keys.end(), key) == keys.end()) {
+			keys.push_back(key);
+		}
+	}
+
+	void sampler::watch_mouse(bool enable)
+	{
+		assert(!this->is_running() && "The mouse must be watched before starting the sampler");
+		mouse = enable;
+	}
+
+	void sampler::start(const sf::Window& target, int rate)
+	{
+		if(this->is_running()) {
+			return;
+		}
+
+		window = &target;
+		interval = std::chrono::duration_cast<clock::duration>(std::chrono::seconds(1)) / std::max(rate, 1);
+		keys_down.reset();
+		buttons_down.reset();
+		mouse_pos = mouse ? sf::Mouse::getPosition(*window) : sf::Vector2i();
+
+		running = true;
+		thread = std::thread([this] { this->run(); });
+	}
+
+	void sampler::stop()
+	{
+		if(!this->is_running()) {
+			return;
+		}
+
+		running = false;
+		thread.join();
+	}
+
+	bool sampler::is_running() const
+	{
+		return running;
+	}
+
+	void sampler::set_focus(bool has_focus)
+	{
+		focused = has_focus;
+	}
+
+	bool sampler::pop(timed_event& out)
+	{
+		return queue.pop(out);
+	}
+
+	sampler::statistics sampler::get_stats() const
+	{
+		return {samples, events, dropped};
+	}
+
+	void sampler::run()
+	{
+		// sleep until the next sample is due, without drifting
+		auto next = clock::now();
+		while(running) {
+			auto now = clock::now();
+			if(focused) {
+				this->sample(now);
+			} else {
+				this->release_all(now);
+			}
+
+			next += interval;
+			if(next < now) {
+				// fell behind, skip the missed samples
+				next = now + interval;
+			}
+			std::this_thread::sleep_until(next);
+		}
+	}
+
+	void sampler::sample(clock::time_point now)
+	{
+		++samples;
+
+		for(auto key : keys) {
+			bool down = sf::Keyboard::isKeyPressed(key);
+			if(down == keys_down[key]) {
+				continue;
+			}
+			keys_down[key] = down;
+
+			this->emit(key_event(key, down), now);
+		}
+
+		if(!mouse) {
+			return;
+		}
+
+		auto pos = sf::Mouse::getPosition(*window);
+		if(pos != mouse_pos) {
+			mouse_pos = pos;
+
+			sf::Event event;
+			event.type = sf::Event::MouseMoved;
+			event.mouseMove.x = pos.x;
+			event.mouseMove.y = pos.y;
+			this->emit(event, now);
+		}
+
+		for(int i = 0; i < sf::Mouse::ButtonCount; ++i) {
+			auto button = sf::Mouse::Button(i);
+			bool down = sf::Mouse::isButtonPressed(button);
+			if(down == buttons_down[i]) {
+				continue;
+			}
+			buttons_down[i] = down;
+
+			sf::Event event;
+			event.type = down ? sf::Event::MouseButtonPressed : sf::Event::MouseButtonReleased;
+			event.mouseButton.button = button;
+			event.mouseButton.x = pos.x;
+			event.mouseButton.y = pos.y;
+			this->emit(event, now);
+		}
+	}
+
+	void sampler::release_all(clock::time_point now)
+	{
+		for(auto key : keys) {
+			if(!keys_down[key]) {
+				continue;
+			}
+			keys_down[key] = false;
+
+			this->emit(key_event(key, false), now);
+		}
+
+		for(int i = 0; i < sf::Mouse::ButtonCount; ++i) {
+			if(!buttons_down[i]) {
+				continue;
+			}
+			buttons_down[i] = false;
+
+			sf::Event event;
+			event.type = sf::Event::MouseButtonReleased;
+			event.mouseButton.button = sf::Mouse::Button(i);
+			event.mouseButton.x = mouse_pos.x;
+			event.mouseButton.y = mouse_pos.y;
+			this->emit(event, now);
+		}
+	}
+
+	void sampler::emit(const sf::Event& event, clock::time_point now)
+	{
+		if(queue.push(timed_event{event, now})) {
+			++events;
+		} else {
+			++dropped;
+		}
+	}
+
+	// }}}
+
+} // namespace input
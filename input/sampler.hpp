@@ -0,0 +1,130 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sfml/window/event.hpp>
+#include <sfml/window/keyboard.hpp>
+#include <sfml/window/mouse.hpp>
+#include <sfml/window/window.hpp>
+
+#include "include/spsc_queue.hpp"
+
+namespace input {
+
+	/**
+	 * \struct timed_event
+	 * \brief Event with the time it was seen
+	 */
+	struct timed_event
+	{
+		sf::Event event;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	/**
+	 * \class sampler
+	 * \brief Thread sampling keyboard and mouse state
+	 *
+	 * Window events are only seen when the frame polls them, so their time
+	 * is rounded to the frame. Instead, this samples the watched keys, and
+	 * optionally the mouse, at a fixed rate on its own thread, and queues
+	 * an event with a timestamp for each change. The frame then drains them
+	 * with pop(), and can apply them at the time they happened.
+	 *
+	 * Only the keys given to watch() before start() are sampled, since each
+	 * is a query to the system. Nothing is sampled while the window doesn't
+	 * have focus (see set_focus()), and keys still down are released when
+	 * it loses focus.
+	 *
+	 * The runtime starts #background_sampler with the --input-rate option.
+	 */
+	class sampler
+	{
+	public: // statics
+
+		using clock = std::chrono::steady_clock;
+		using key_type = sf::Keyboard::Key;
+
+		struct statistics
+		{
+			uint64_t samples; // times the state was sampled
+			uint64_t events; // events queued
+			uint64_t dropped; // events lost to a full queue
+		};
+
+	private: // variables
+
+		const sf::Window* window;
+		clock::duration interval;
+
+		std::thread thread;
+		std::atomic<bool> running;
+		std::atomic<bool> focused;
+
+		std::vector<key_type> keys;
+		bool mouse;
+
+		spsc_queue<timed_event, 1024> queue;
+
+		// state as last sampled, only used on the thread
+		std::bitset<sf::Keyboard::KeyCount> keys_down;
+		std::bitset<sf::Mouse::ButtonCount> buttons_down;
+		sf::Vector2i mouse_pos;
+
+		std::atomic<uint64_t> samples;
+		std::atomic<uint64_t> events;
+		std::atomic<uint64_t> dropped;
+
+	private: // internal methods
+
+		void run();
+		void sample(clock::time_point now);
+		void release_all(clock::time_point now);
+		void emit(const sf::Event& event, clock::time_point now);
+
+	public: // methods
+
+		sampler();
+		~sampler();
+
+		sampler(const sampler&) = delete;
+		sampler& operator=(const sampler&) = delete;
+
+		/// Sample a key. Only before start()
+		void watch(key_type key);
+
+		/// Sample mouse position and buttons. Only before start()
+		void watch_mouse(bool enable = true);
+
+		/// Start sampling \p rate times a second, with the mouse relative to \p target
+		void start(const sf::Window& target, int rate);
+		void stop();
+
+		bool is_running() const;
+
+		/// Tell the thread whether the window has focus
+		void set_focus(bool has_focus);
+
+		/// Take the oldest event, in the order seen. Returns false if none
+		bool pop(timed_event& out);
+
+		statistics get_stats() const;
+
+	};
+
+	/**
+	 * \var background_sampler
+	 * \brief Sampler run by the runtime
+	 *
+	 * Programs add the keys they use with watch() in initial(), and drain
+	 * it each frame when it is running.
+	 */
+	extern sampler background_sampler;
+
+} // namespace input
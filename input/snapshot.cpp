@@ -0,0 +1,161 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+
+namespace input {
+
+	snapshot frame_keys;
+
+	// class snapshot {{{
+
+	snapshot::snapshot()
+		: down()
+		, pressed_edges()
+		, released_edges()
+	{
+	}
+
+	bool snapshot::valid(key_type key)
+	{
+		return key >= 0 && size_t(key) < key_count;
+	}
+
+	void snapshot::process(const sf::Event& e)
+	{
+		if(e.type == sf::Event::KeyPressed) {
+			if(valid(e.key.code) && !down[e.key.code]) {
+				down.set(e.key.code);
+				pressed_edges.set(e.key.code);
+			}
+		} else if(e.type == sf::Event::KeyReleased) {
+			if(valid(e.key.code) && down[e.key.code]) {
+				down.reset(e.key.code);
+				released_edges.set(e.key.code);
+			}
+		} else if(e.type == sf::Event::LostFocus) {
+			// releases are not sent to an unfocused window
+			this->release_all();
+		}
+	}
+
+	void snapshot::advance()
+	{
+		pressed_edges.reset();
+		released_edges.reset();
+	}
+
+	void snapshot::capture()
+	{
+		for(size_t i = 0; i < key_count; ++i) {
+			bool now = sf::Keyboard::isKeyPressed(key_type(i));
+			if(now != down[i]) {
+				(now ? pressed_edges : released_edges).set(i);
+				down.set(i, now);
+			}
+		}
+	}
+
+	void snapshot::release_all()
+	{
+		released_edges |= down;
+		down.reset();
+	}
+
+	bool snapshot::pressed(key_type key) const
+	{
+		return valid(key) && down[key];
+	}
+
+	bool snapshot::just_pressed(key_type key) const
+	{
+		return valid(key) && pressed_edges[key];
+	}
+
+	bool snapshot::just_released(key_type key) const
+	{
+		return valid(key) && released_edges[key];
+	}
+
+	bool snapshot::was_pressed(key_type key) const
+	{
+		// a key with one edge this frame has changed, with two it has changed back
+		return valid(key) && (down[key] != (pressed_edges[key] != released_edges[key]));
+	}
+
+	// }}}
+
+	// class action_map {{{
+
+	void action_map::bind(action_type action, key_type key)
+	{
+		if(action >= bindings.size()) {
+			bindings.resize(action + 1);
+		}
+		auto& keys = bindings[action];
+		if(std::find(keys.begin(), keys.end(), key) == keys.end()) {
+			keys.push_back(key);
+		}
+	}
+
+	void action_map::unbind(action_type action, key_type key)
+	{
+		if(action >= bindings.size()) {
+			return;
+		}
+		auto& keys = bindings[action];
+		keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+	}
+
+	void action_map::clear(action_type action)
+	{
+		if(action < bindings.size()) {
+			bindings[action].clear();
+		}
+	}
+
+	const std::vector<action_map::key_type>& action_map::keys(action_type action) const
+	{
+		static const std::vector<key_type> none;
+		return action < bindings.size() ? bindings[action] : none;
+	}
+
+	bool action_map::pressed(action_type action, const snapshot& state) const
+	{
+		auto& keys = this->keys(action);
+		return std::any_of(keys.begin(), keys.end(), [&state] (key_type key) { return state.pressed(key); });
+	}
+
+	bool action_map::just_pressed(action_type action, const snapshot& state) const
+	{
+		// holding another key already pressed the action
+		auto& keys = this->keys(action);
+		return std::any_of(keys.begin(), keys.end(), [&state] (key_type key) { return state.just_pressed(key); })
+			&& std::none_of(keys.begin(), keys.end(), [&state] (key_type key) { return state.was_pressed(key); });
+	}
+
+	bool action_map::just_released(action_type action, const snapshot& state) const
+	{
+		// still pressed while any other key is down
+		auto& keys = this->keys(action);
+		return !this->pressed(action, state)
+			&& std::any_of(keys.begin(), keys.end(), [&state] (key_type key) { return state.just_released(key); });
+	}
+
+	bool action_map::pressed(action_type action) const
+	{
+		return this->pressed(action, frame_keys);
+	}
+
+	bool action_map::just_pressed(action_type action) const
+	{
+		return this->just_pressed(action, frame_keys);
+	}
+
+	bool action_map::just_released(action_type action) const
+	{
+		return this->just_released(action, frame_keys);
+	}
+
+	// }}}
+
+} // namespace input
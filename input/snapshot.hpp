@@ -0,0 +1,124 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <bitset>
+#include <vector>
+
+#include <sfml/window/event.hpp>
+#include <sfml/window/keyboard.hpp>
+
+/**
+ * \namespace input
+ * \brief Per-frame input state
+ */
+namespace input {
+
+	/**
+	 * \class snapshot
+	 * \brief Keyboard state for a frame
+	 *
+	 * This holds which keys are down, and which were pressed or released
+	 * this frame, as bitsets. Reading a key is then a bit test, which is the
+	 * same for the whole frame, instead of a query to the system.
+	 *
+	 * The state is kept from KeyPressed and KeyReleased events given to
+	 * process(), and advance() starts a new frame. The runtime does both for
+	 * #frame_keys, so only keys pressed while the window has focus are seen.
+	 * capture() queries every key instead, for use without events.
+	 */
+	class snapshot
+	{
+	public: // statics
+
+		using key_type = sf::Keyboard::Key;
+		static constexpr size_t key_count = sf::Keyboard::KeyCount;
+
+	private: // variables
+
+		std::bitset<key_count> down;
+		std::bitset<key_count> pressed_edges;
+		std::bitset<key_count> released_edges;
+
+	private: // internal methods
+
+		static bool valid(key_type key);
+
+	public: // methods
+
+		snapshot();
+
+		/// Update the keys from an event
+		void process(const sf::Event& e);
+
+		/// Start a new frame, clearing the presses and releases
+		void advance();
+
+		/// Query the state of every key from sf::Keyboard
+		void capture();
+
+		/// Release every key, e.g. when focus is lost
+		void release_all();
+
+		/// Key is down
+		bool pressed(key_type key) const;
+
+		/// Key went down this frame
+		bool just_pressed(key_type key) const;
+
+		/// Key went up this frame
+		bool just_released(key_type key) const;
+
+		/// Key was down at the start of the frame
+		bool was_pressed(key_type key) const;
+
+	};
+
+	/**
+	 * \class action_map
+	 * \brief Actions bound to keys
+	 *
+	 * Each action is bound to any number of keys, and is pressed when any of
+	 * them are down. An action is only just pressed if none of its keys were
+	 * already down. Actions are numbered from 0, e.g. with an enum.
+	 */
+	class action_map
+	{
+	public: // statics
+
+		using action_type = size_t;
+		using key_type = snapshot::key_type;
+
+	private: // variables
+
+		std::vector<std::vector<key_type>> bindings;
+
+	public: // methods
+
+		void bind(action_type action, key_type key);
+		void unbind(action_type action, key_type key);
+
+		/// Remove every key bound to the action
+		void clear(action_type action);
+
+		const std::vector<key_type>& keys(action_type action) const;
+
+		bool pressed(action_type action, const snapshot& state) const;
+		bool just_pressed(action_type action, const snapshot& state) const;
+		bool just_released(action_type action, const snapshot& state) const;
+
+		bool pressed(action_type action) const;
+		bool just_pressed(action_type action) const;
+		bool just_released(action_type action) const;
+
+	};
+
+	/**
+	 * \var frame_keys
+	 * \brief Keyboard state of the current frame
+	 *
+	 * The runtime gives this every window event, and advances it at the
+	 * start of each frame. keystate and action_map read from this.
+	 */
+	extern snapshot frame_keys;
+
+} // namespace input
@@ -0,0 +1,228 @@
+#include "switchboard.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+// class switchboard {{{
+
+switchboard::switchboard(const rect_type& init_area, int init_cell_size)
+	: buttons()
+	, used()
+	, free_ids()
+	, area(init_area)
+	, cell_size(std::max(init_cell_size, 1))
+	, columns(std::max((init_area.width + cell_size - 1) / cell_size, 1))
+	, rows(std::max((init_area.height + cell_size - 1) / cell_size, 1))
+	, cells(size_t(columns * rows))
+	, engaged()
+	, is_engaged()
+	, visited()
+	, stamp(0)
+	, pending()
+{
+}
+
+int switchboard::column_of(int x) const
+{
+	// anything left of the area is in the first column
+	int offset = x - area.left;
+	return offset < 0 ? 0 : std::min(offset / cell_size, columns - 1);
+}
+
+int switchboard::row_of(int y) const
+{
+	int offset = y - area.top;
+	return offset < 0 ? 0 : std::min(offset / cell_size, rows - 1);
+}
+
+bool switchboard::cell_range(const rect_type& bound, int& x0, int& y0, int& x1, int& y1) const
+{
+	if(bound.width <= 0 || bound.height <= 0) {
+		return false;
+	}
+
+	x0 = this->column_of(bound.left);
+	y0 = this->row_of(bound.top);
+	x1 = this->column_of(bound.left + bound.width - 1);
+	y1 = this->row_of(bound.top + bound.height - 1);
+	return true;
+}
+
+void switchboard::index(id_type id)
+{
+	int x0, y0, x1, y1;
+	if(!this->cell_range(buttons[id].region(), x0, y0, x1, y1)) {
+		return;
+	}
+	for(int y = y0; y <= y1; ++y) {
+		for(int x = x0; x <= x1; ++x) {
+			cells[size_t(y * columns + x)].push_back(id);
+		}
+	}
+}
+
+void switchboard::unindex(id_type id)
+{
+	int x0, y0, x1, y1;
+	if(!this->cell_range(buttons[id].region(), x0, y0, x1, y1)) {
+		return;
+	}
+	for(int y = y0; y <= y1; ++y) {
+		for(int x = x0; x <= x1; ++x) {
+			auto& cell = cells[size_t(y * columns + x)];
+			cell.erase(std::remove(cell.begin(), cell.end(), id), cell.end());
+		}
+	}
+}
+
+void switchboard::route(id_type id, const sf::Event& e)
+{
+	if(visited[id] == stamp) {
+		return;
+	}
+	visited[id] = stamp;
+	this->collect(id, buttons[id].process(e));
+}
+
+void switchboard::collect(id_type id, const button::event_list& events)
+{
+	for(auto what : events) {
+		pending.push_back(change{id, what});
+	}
+
+	bool idle = buttons[id].current_state() == button::state::idle;
+	if(!idle && !is_engaged[id]) {
+		is_engaged[id] = true;
+		engaged.push_back(id);
+	}
+	// idle buttons are dropped from engaged after each event
+}
+
+switchboard::id_type switchboard::add(const rect_type& bound)
+{
+	id_type id;
+	if(!free_ids.empty()) {
+		id = free_ids.back();
+		free_ids.pop_back();
+		buttons[id] = button(bound);
+		used[id] = true;
+	} else {
+		id = id_type(buttons.size());
+		buttons.emplace_back(bound);
+		used.push_back(true);
+		is_engaged.push_back(false);
+		visited.push_back(0);
+	}
+
+	this->index(id);
+	return id;
+}
+
+void switchboard::remove(id_type id)
+{
+	assert(this->contains(id) && "Removing a button not in the switchboard");
+
+	this->unindex(id);
+	if(is_engaged[id]) {
+		is_engaged[id] = false;
+		engaged.erase(std::remove(engaged.begin(), engaged.end(), id), engaged.end());
+	}
+	used[id] = false;
+	free_ids.push_back(id);
+}
+
+void switchboard::move(id_type id, const rect_type& bound)
+{
+	assert(this->contains(id) && "Moving a button not in the switchboard");
+
+	this->unindex(id);
+	this->collect(id, buttons[id].region(bound));
+	this->index(id);
+}
+
+const button& switchboard::get(id_type id) const
+{
+	assert(this->contains(id) && "Getting a button not in the switchboard");
+	return buttons[id];
+}
+
+bool switchboard::contains(id_type id) const
+{
+	return id < used.size() && used[id];
+}
+
+size_t switchboard::size() const
+{
+	return buttons.size() - free_ids.size();
+}
+
+void switchboard::process(const sf::Event& e)
+{
+	// a new stamp marks every button as not yet given this event
+	if(++stamp == 0) {
+		std::fill(visited.begin(), visited.end(), 0);
+		stamp = 1;
+	}
+
+	// buttons under the cursor may change, the rest only if engaged
+	auto route_cell = [this, &e] (int x, int y) {
+		vec2i pos(x, y);
+		for(auto id : cells[size_t(this->row_of(y) * columns + this->column_of(x))]) {
+			if(buttons[id].contains(pos)) {
+				this->route(id, e);
+			}
+		}
+	};
+
+	// engaged may grow while routing, so this iterates by index
+	auto route_engaged = [this, &e] () {
+		size_t count = engaged.size();
+		for(size_t i = 0; i < count; ++i) {
+			this->route(engaged[i], e);
+		}
+	};
+
+	switch(e.type) {
+	case sf::Event::MouseMoved:
+		route_engaged();
+		route_cell(e.mouseMove.x, e.mouseMove.y);
+		break;
+	case sf::Event::MouseButtonPressed:
+		route_cell(e.mouseButton.x, e.mouseButton.y);
+		break;
+	case sf::Event::MouseButtonReleased:
+	case sf::Event::LostFocus:
+	case sf::Event::MouseLeft:
+		// idle buttons are unaffected by these
+		route_engaged();
+		break;
+	default:
+		return;
+	}
+
+	// drop buttons which became idle
+	auto now_idle = [this] (id_type id) {
+		if(buttons[id].current_state() != button::state::idle) {
+			return false;
+		}
+		is_engaged[id] = false;
+		return true;
+	};
+	engaged.erase(std::remove_if(engaged.begin(), engaged.end(), now_idle), engaged.end());
+}
+
+const std::vector<switchboard::change>& switchboard::get_pending() const
+{
+	return pending;
+}
+
+void switchboard::dispatch()
+{
+	if(pending.empty()) {
+		return;
+	}
+	on_change(pending);
+	pending.clear();
+}
+
+// }}}
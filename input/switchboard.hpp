@@ -0,0 +1,121 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sfml/graphics/rect.hpp>
+#include <sfml/window/event.hpp>
+
+#include "include/sigslots.hpp"
+#include "include/vector.hpp"
+#include "input/button.hpp"
+
+/**
+ * \class switchboard
+ * \brief Set of buttons, routed events through a spatial index
+ *
+ * This owns many buttons, and passes mouse events only to the buttons they
+ * can affect, instead of every button testing every event. Buttons are
+ * indexed in a uniform grid over the window, so a mouse event only tests the
+ * buttons in the cell under the cursor, and the few buttons which are not
+ * idle (hovered or pressed), which may need to leave that state. Buttons and
+ * positions outside the area go in the nearest edge cells.
+ *
+ * State changes are collected as events are processed, and emitted
+ * together by dispatch(), e.g. once per frame:
+ *
+ *     for(auto type : {sf::Event::MouseMoved, sf::Event::MouseButtonPressed,
+ *                      sf::Event::MouseButtonReleased, sf::Event::MouseLeft,
+ *                      sf::Event::LostFocus}) {
+ *         rt::on_event[type].connect([] (const sf::Event& e) { board.process(e); });
+ *     }
+ *     rt::on_frame.connect([] { board.dispatch(); });
+ *
+ * Buttons are referred to by ids, which stay valid until removed, after
+ * which they may be reused.
+ */
+class switchboard
+{
+public: // statics
+
+	using id_type = uint32_t;
+	using rect_type = sf::Rect<button::dimension_type>;
+
+	/// A state change of a button
+	struct change
+	{
+		id_type id;
+		button::event what;
+	};
+
+private: // variables
+
+	std::vector<button> buttons;
+	std::vector<bool> used;
+	std::vector<id_type> free_ids;
+
+	// uniform grid of button ids, covering the area
+	rect_type area;
+	int cell_size;
+	int columns;
+	int rows;
+	std::vector<std::vector<id_type>> cells;
+
+	// buttons not idle, which may change without the cursor over them
+	std::vector<id_type> engaged;
+	std::vector<bool> is_engaged;
+
+	// buttons already given the current event
+	std::vector<uint32_t> visited;
+	uint32_t stamp;
+
+	std::vector<change> pending;
+
+private: // internal methods
+
+	// cell of a position, clamped to the grid, so the edge cells hold anything past it
+	int column_of(int x) const;
+	int row_of(int y) const;
+
+	// range of cells covered by a rectangle, false if it covers none
+	bool cell_range(const rect_type& bound, int& x0, int& y0, int& x1, int& y1) const;
+	void index(id_type id);
+	void unindex(id_type id);
+
+	// gives the button the event, once per event
+	void route(id_type id, const sf::Event& e);
+	void collect(id_type id, const button::event_list& events);
+
+public: // variables
+
+	/// Emitted by dispatch() with the changes since the last dispatch
+	signal<const std::vector<change>&> on_change;
+
+public: // methods
+
+	/// Cover \p init_area (e.g. the window) with cells \p init_cell_size pixels wide
+	explicit switchboard(const rect_type& init_area, int init_cell_size = 64);
+
+	id_type add(const rect_type& bound);
+	void remove(id_type id);
+
+	/// Move or resize a button, which becomes idle
+	void move(id_type id, const rect_type& bound);
+
+	const button& get(id_type id) const;
+	bool contains(id_type id) const;
+
+	/// Number of buttons
+	size_t size() const;
+
+	/// Route an event to the buttons it affects
+	void process(const sf::Event& e);
+
+	/// Changes collected since the last dispatch
+	const std::vector<change>& get_pending() const;
+
+	/// Emit on_change with the collected changes, if any
+	void dispatch();
+
+};
@@ -0,0 +1,528 @@
+#include "async_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+
+#if defined(PLATFORM_LINUX)
+	#include <fcntl.h>
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace res {
+
+	// class async_reader::buffer_pool {{{
+
+	// buffers are returned here when their result is released
+	class async_reader::buffer_pool : public std::enable_shared_from_this<buffer_pool>
+	{
+	private: // variables
+
+		std::mutex lock;
+		std::vector<std::unique_ptr<std::vector<uint8_t>>> free;
+
+		static constexpr size_t max_free = 16;
+
+	public: // methods
+
+		buffer_ptr acquire(uint64_t size)
+		{
+			std::unique_ptr<std::vector<uint8_t>> buf;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				auto fits = std::find_if(free.begin(), free.end(), [size] (auto& b) {
+						return b->capacity() >= size;
+					});
+				if(fits != free.end()) {
+					buf = std::move(*fits);
+					free.erase(fits);
+				}
+			}
+			if(!buf) {
+				buf.reset(new std::vector<uint8_t>());
+			}
+			buf->resize(size);
+
+			std::weak_ptr<buffer_pool> owner = this->shared_from_this();
+			return buffer_ptr(buf.release(), [owner] (std::vector<uint8_t>* b) {
+					std::unique_ptr<std::vector<uint8_t>> held(b);
+					if(auto pool = owner.lock()) {
+						pool->release(std::move(held));
+					}
+				});
+		}
+
+		void release(std::unique_ptr<std::vector<uint8_t>> buf)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if(free.size() < max_free) {
+				free.push_back(std::move(buf));
+			}
+		}
+
+	};
+
+	// }}}
+
+#if defined(PLATFORM_LINUX)
+
+	namespace { // anonymous
+
+		int io_uring_setup(unsigned entries, io_uring_params* params)
+		{
+			return int(syscall(__NR_io_uring_setup, entries, params));
+		}
+
+		int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+		{
+			return int(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+		}
+
+		template <typename T>
+		T* ring_ptr(void* ring, unsigned offset)
+		{
+			return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+		}
+
+	} // namespace anonymous
+
+#endif
+
+	// class async_reader {{{
+
+	async_reader::async_reader(unsigned int queue_depth, unsigned int threads)
+		: pool(std::make_shared<buffer_pool>()), queue_lock(), queue_cv(), pending()
+		, stopping(false), workers(), fallback_threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+#if defined(PLATFORM_LINUX)
+		, ring_fd(-1), sq_ring(nullptr), sq_ring_size(0), cq_ring(nullptr), cq_ring_size(0)
+		, sqes(nullptr), sqes_size(0), ring_entries(0)
+		, sq_head(nullptr), sq_tail(nullptr), sq_mask(0), sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr), cq_mask(0), cqes(nullptr)
+		, slots(), in_flight(0), abandoned(), ring_active(false)
+#endif
+	{
+#if defined(PLATFORM_LINUX)
+		if(this->setup_ring(std::max(1u, queue_depth))) {
+			ring_active = true;
+			workers.emplace_back([this] { this->ring_loop(); });
+			return;
+		}
+#else
+		(void)(queue_depth);
+#endif
+
+		for(unsigned int i = 0; i < fallback_threads; ++i) {
+			workers.emplace_back([this] { this->worker_loop(); });
+		}
+	}
+
+	async_reader::~async_reader()
+	{
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			stopping = true;
+			// destroying the batches breaks their promises
+			pending.clear();
+		}
+		queue_cv.notify_all();
+
+		for(auto& worker : workers) {
+			worker.join();
+		}
+
+#if defined(PLATFORM_LINUX)
+		this->close_ring();
+#endif
+	}
+
+	bool async_reader::uses_io_uring() const
+	{
+#if defined(PLATFORM_LINUX)
+		return ring_active;
+#else
+		return false;
+#endif
+	}
+
+	std::future<std::vector<async_reader::read_result>> async_reader::read(std::vector<read_request> requests)
+	{
+		auto b = std::make_shared<batch>();
+		b->requests = std::move(requests);
+		b->results.resize(b->requests.size());
+		b->remaining = b->requests.size();
+		auto result = b->done.get_future();
+
+		if(b->requests.empty()) {
+			b->done.set_value({});
+			return result;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			for(size_t i = 0; i < b->requests.size(); ++i) {
+				pending.push_back(job{b, i});
+			}
+		}
+		queue_cv.notify_all();
+		return result;
+	}
+
+	void async_reader::finish(const job& j)
+	{
+		// the last read of the batch hands over the results
+		if(--j.owner->remaining == 0) {
+			j.owner->done.set_value(std::move(j.owner->results));
+		}
+	}
+
+	void async_reader::worker_loop()
+	{
+		while(true) {
+			job j;
+			{
+				std::unique_lock<std::mutex> lock(queue_lock);
+				queue_cv.wait(lock, [this] { return stopping || !pending.empty(); });
+				if(stopping) {
+					return;
+				}
+				j = std::move(pending.front());
+				pending.pop_front();
+			}
+			this->read_blocking(j);
+			finish(j);
+		}
+	}
+
+	void async_reader::read_blocking(const job& j)
+	{
+		auto& request = j.owner->requests[j.index];
+		auto& result = j.owner->results[j.index];
+
+		if(request.buffer && request.size == 0) {
+			// the size of the buffer is unknown
+			result.ec = std::make_error_code(std::errc::invalid_argument);
+			return;
+		}
+
+		std::ifstream in(request.filename, std::ifstream::binary);
+		if(!in) {
+			result.ec = std::error_code(errno ? errno : ENOENT, std::generic_category());
+			return;
+		}
+
+		in.seekg(0, std::ifstream::end);
+		uint64_t file_size = uint64_t(in.tellg());
+		uint64_t available = request.offset < file_size ? file_size - request.offset : 0;
+		uint64_t wanted = request.size == 0 ? available : std::min(request.size, available);
+
+		uint8_t* dest = static_cast<uint8_t*>(request.buffer);
+		if(!dest) {
+			result.pooled = pool->acquire(wanted);
+			dest = result.pooled->data();
+		}
+
+		in.seekg(std::streamoff(request.offset));
+		in.read(reinterpret_cast<char*>(dest), std::streamsize(wanted));
+		if(uint64_t(in.gcount()) != wanted) {
+			result.ec = std::make_error_code(std::errc::io_error);
+			result.pooled.reset();
+			return;
+		}
+
+		result.data = dest;
+		result.size = wanted;
+	}
+
+#if defined(PLATFORM_LINUX)
+
+	bool async_reader::setup_ring(unsigned entries)
+	{
+		io_uring_params p{};
+		ring_fd = io_uring_setup(entries, &p);
+		if(ring_fd < 0) {
+			// e.g. ENOSYS on old kernels, or EPERM when disabled
+			ring_fd = -1;
+			return false;
+		}
+
+		sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+		if(p.features & IORING_FEAT_SINGLE_MMAP) {
+			sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+		}
+
+		sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+		if(sq_ring == MAP_FAILED) {
+			sq_ring = nullptr;
+			this->close_ring();
+			return false;
+		}
+
+		if(p.features & IORING_FEAT_SINGLE_MMAP) {
+			cq_ring = sq_ring;
+		} else {
+			cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+			if(cq_ring == MAP_FAILED) {
+				cq_ring = nullptr;
+				this->close_ring();
+				return false;
+			}
+		}
+
+		sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+		sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+		if(sqes == MAP_FAILED) {
+			sqes = nullptr;
+			this->close_ring();
+			return false;
+		}
+
+		ring_entries = p.sq_entries;
+
+		sq_head = ring_ptr<unsigned>(sq_ring, p.sq_off.head);
+		sq_tail = ring_ptr<unsigned>(sq_ring, p.sq_off.tail);
+		sq_mask = *ring_ptr<unsigned>(sq_ring, p.sq_off.ring_mask);
+		sq_array = ring_ptr<unsigned>(sq_ring, p.sq_off.array);
+		cq_head = ring_ptr<unsigned>(cq_ring, p.cq_off.head);
+		cq_tail = ring_ptr<unsigned>(cq_ring, p.cq_off.tail);
+		cq_mask = *ring_ptr<unsigned>(cq_ring, p.cq_off.ring_mask);
+		cqes = ring_ptr<io_uring_cqe>(cq_ring, p.cq_off.cqes);
+
+		slots.assign(ring_entries, slot{job{}, -1, nullptr, 0, 0, 0, false});
+		return true;
+	}
+
+	void async_reader::close_ring()
+	{
+		if(sqes) {
+			munmap(sqes, sqes_size);
+		}
+		if(cq_ring && cq_ring != sq_ring) {
+			munmap(cq_ring, cq_ring_size);
+		}
+		if(sq_ring) {
+			munmap(sq_ring, sq_ring_size);
+		}
+		if(ring_fd != -1) {
+			::close(ring_fd);
+		}
+		sqes = sq_ring = cq_ring = nullptr;
+		ring_fd = -1;
+	}
+
+	void async_reader::ring_loop()
+	{
+		while(true) {
+			// fill the free slots from the queue
+			std::vector<job> starting;
+			{
+				std::unique_lock<std::mutex> lock(queue_lock);
+				if(in_flight == 0) {
+					queue_cv.wait(lock, [this] { return stopping || !pending.empty(); });
+				}
+				// reads in flight are finished before stopping, as the kernel uses the buffers
+				if(stopping && in_flight == 0) {
+					return;
+				}
+				while(!stopping && !pending.empty() && in_flight + starting.size() < ring_entries) {
+					starting.push_back(std::move(pending.front()));
+					pending.pop_front();
+				}
+			}
+
+			for(auto& j : starting) {
+				if(!this->start_read(j)) {
+					// nothing to read, or the file could not be opened
+					finish(j);
+				}
+			}
+
+			if(in_flight > 0) {
+				if(!this->submit_and_wait(1)) {
+					// the ring is unusable, so the rest is read by threads
+					this->abandon_ring();
+					break;
+				}
+				this->reap();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			// the destructor joins the workers once stopping is set, so none are added after
+			for(unsigned int i = 1; !stopping && i < fallback_threads; ++i) {
+				workers.emplace_back([this] { this->worker_loop(); });
+			}
+		}
+		this->worker_loop();
+	}
+
+	bool async_reader::start_read(const job& j)
+	{
+		auto& request = j.owner->requests[j.index];
+		auto& result = j.owner->results[j.index];
+
+		if(request.buffer && request.size == 0) {
+			// the size of the buffer is unknown
+			result.ec = std::make_error_code(std::errc::invalid_argument);
+			return false;
+		}
+
+		int fd = ::open(request.filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd == -1) {
+			result.ec = std::error_code(errno, std::generic_category());
+			return false;
+		}
+
+		struct stat st;
+		if(fstat(fd, &st) != 0) {
+			result.ec = std::error_code(errno, std::generic_category());
+			::close(fd);
+			return false;
+		}
+
+		uint64_t file_size = uint64_t(st.st_size);
+		uint64_t available = request.offset < file_size ? file_size - request.offset : 0;
+		uint64_t wanted = request.size == 0 ? available : std::min(request.size, available);
+
+		uint8_t* dest = static_cast<uint8_t*>(request.buffer);
+		if(!dest) {
+			result.pooled = pool->acquire(wanted);
+			dest = result.pooled->data();
+		}
+		result.data = dest;
+		result.size = 0;
+
+		if(wanted == 0) {
+			::close(fd);
+			return false;
+		}
+
+		auto free_slot = std::find_if(slots.begin(), slots.end(), [] (const slot& s) { return !s.in_use; });
+		*free_slot = slot{j, fd, dest, request.offset, wanted, 0, true};
+		++in_flight;
+
+		this->queue_read(size_t(free_slot - slots.begin()));
+		return true;
+	}
+
+	void async_reader::queue_read(size_t index)
+	{
+		auto& s = slots[index];
+
+		// only this thread writes the tail
+		unsigned tail = *sq_tail;
+		unsigned pos = tail & sq_mask;
+
+		auto remaining = s.wanted - s.done;
+		auto& sqe = static_cast<io_uring_sqe*>(sqes)[pos];
+		sqe = io_uring_sqe{};
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = s.fd;
+		sqe.off = s.offset + s.done;
+		sqe.addr = reinterpret_cast<uint64_t>(s.dest + s.done);
+		// reads are limited to 2 GiB - 4 KiB, the rest is resubmitted
+		sqe.len = unsigned(std::min<uint64_t>(remaining, 0x7ffff000));
+		sqe.user_data = index;
+
+		sq_array[pos] = pos;
+		__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	bool async_reader::submit_and_wait(unsigned wait_for)
+	{
+		while(true) {
+			// everything queued since the last call, including reads the kernel did not take then
+			unsigned to_submit = *sq_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+			if(io_uring_enter(ring_fd, to_submit, wait_for, IORING_ENTER_GETEVENTS) >= 0) {
+				return true;
+			}
+			if(errno == EAGAIN || errno == EBUSY) {
+				// out of resources, or the completion queue is full, so reap and try again
+				return true;
+			}
+			if(errno != EINTR) {
+				return false;
+			}
+		}
+	}
+
+	void async_reader::abandon_ring()
+	{
+		// closing the ring cancels the reads the kernel has taken, or waits for them
+		this->close_ring();
+		ring_active = false;
+
+		for(auto& s : slots) {
+			if(!s.in_use) {
+				continue;
+			}
+			::close(s.fd);
+
+			// a read the kernel still had would write the same bytes, but not into a reused buffer
+			auto& result = s.current.owner->results[s.current.index];
+			if(result.pooled) {
+				abandoned.push_back(std::move(result.pooled));
+			}
+			result = read_result{};
+			this->read_blocking(s.current);
+
+			auto done_job = std::move(s.current);
+			s = slot{job{}, -1, nullptr, 0, 0, 0, false};
+			--in_flight;
+			finish(done_job);
+		}
+	}
+
+	void async_reader::reap()
+	{
+		auto completions = static_cast<io_uring_cqe*>(cqes);
+
+		unsigned head = *cq_head;
+		unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+		for(; head != tail; ++head) {
+			auto& cqe = completions[head & cq_mask];
+			auto& s = slots[size_t(cqe.user_data)];
+			auto& result = s.current.owner->results[s.current.index];
+
+			if(cqe.res > 0) {
+				s.done += uint64_t(cqe.res);
+				if(s.done < s.wanted) {
+					// short read, continue from where it stopped
+					this->queue_read(size_t(cqe.user_data));
+					continue;
+				}
+			} else if(cqe.res < 0) {
+				result.ec = std::error_code(-cqe.res, std::generic_category());
+			} else if(s.done < s.wanted) {
+				// the file is shorter than it was, as read_blocking reports it
+				result.ec = std::make_error_code(std::errc::io_error);
+			}
+
+			if(result.ec) {
+				result.pooled.reset();
+				result.data = nullptr;
+				result.size = 0;
+			} else {
+				result.size = s.done;
+			}
+			::close(s.fd);
+			auto done_job = std::move(s.current);
+			s = slot{job{}, -1, nullptr, 0, 0, 0, false};
+			--in_flight;
+			finish(done_job);
+		}
+
+		// short reads queued again are submitted with the next wait
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+
+#endif
+
+	// }}}
+
+} // namespace res
@@ -0,0 +1,180 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+
+namespace res {
+
+	/**
+	 * \class async_reader
+	 * \brief Batched asynchronous file reads
+	 *
+	 * This reads whole files (or parts of them) into memory, for resources
+	 * which should not be memory-mapped, e.g. on network filesystems or
+	 * which are decompressed anyway. Reads are submitted in batches, and
+	 * the results of a batch are available through a std::future.
+	 *
+	 * On Linux (5.6 and later), reads are queued through io_uring, so many
+	 * reads can be in flight at once instead of waiting on each syscall.
+	 * Where io_uring is unavailable (other platforms, older kernels, or
+	 * restricted environments), a pool of threads reads the files instead.
+	 * The threads also take over if the ring fails while reads are queued.
+	 *
+	 * Reads go into a buffer given with the request, or otherwise into a
+	 * buffer from an internal pool, which is reused once the result is
+	 * released.
+	 */
+	class async_reader
+	{
+	public: // statics
+
+		using buffer_ptr = std::shared_ptr<std::vector<uint8_t>>;
+
+		struct read_request
+		{
+			std::string filename;
+			/// Buffer to read into, or null for a pooled buffer
+			void* buffer;
+			/// Maximum bytes to read, 0 for the rest of the file (an error with a buffer)
+			uint64_t size;
+			uint64_t offset;
+		};
+
+		struct read_result
+		{
+			std::error_code ec;
+			/// Start of the data, in the request buffer or #pooled
+			const uint8_t* data;
+			/// Bytes read, which is less than requested at the end of the file
+			uint64_t size;
+			/// Holds the pooled buffer, if one was used
+			buffer_ptr pooled;
+		};
+
+	private: // statics
+
+		struct batch
+		{
+			std::vector<read_request> requests;
+			std::vector<read_result> results;
+			std::promise<std::vector<read_result>> done;
+			std::atomic<size_t> remaining;
+		};
+
+		struct job
+		{
+			std::shared_ptr<batch> owner;
+			size_t index;
+		};
+
+		// a read being done through io_uring
+		struct slot
+		{
+			job current;
+			int fd;
+			uint8_t* dest;
+			uint64_t offset;
+			uint64_t wanted;
+			uint64_t done;
+			bool in_use;
+		};
+
+		class buffer_pool;
+
+	private: // variables
+
+		std::shared_ptr<buffer_pool> pool;
+
+		std::mutex queue_lock;
+		std::condition_variable queue_cv;
+		std::deque<job> pending;
+		bool stopping;
+
+		std::vector<std::thread> workers;
+		unsigned int fallback_threads;
+
+#if defined(PLATFORM_LINUX)
+		int ring_fd;
+		void* sq_ring;
+		size_t sq_ring_size;
+		void* cq_ring;
+		size_t cq_ring_size;
+		void* sqes;
+		size_t sqes_size;
+		unsigned ring_entries;
+
+		// fields in the shared rings
+		unsigned* sq_head;
+		unsigned* sq_tail;
+		unsigned sq_mask;
+		unsigned* sq_array;
+		unsigned* cq_head;
+		unsigned* cq_tail;
+		unsigned cq_mask;
+		void* cqes;
+
+		std::vector<slot> slots;
+		size_t in_flight;
+
+		// buffers of reads the kernel had when the ring was given up, in case it still writes to them
+		std::vector<buffer_ptr> abandoned;
+
+		// read from other threads, while the ring may be given up
+		std::atomic<bool> ring_active;
+#endif
+
+	private: // internal methods
+
+		static void finish(const job& j);
+
+		// fallback, reads with a blocking file on each worker
+		void worker_loop();
+		void read_blocking(const job& j);
+
+#if defined(PLATFORM_LINUX)
+		bool setup_ring(unsigned entries);
+		void close_ring();
+		void ring_loop();
+		bool start_read(const job& j);
+		void queue_read(size_t index);
+		bool submit_and_wait(unsigned wait_for);
+		void abandon_ring();
+		void reap();
+#endif
+
+	public: // methods
+
+		/**
+		 * Create a reader, with up to \p queue_depth reads in flight.
+		 * If io_uring is unavailable, \p threads workers are used
+		 * instead (one per core if 0).
+		 */
+		explicit async_reader(unsigned int queue_depth = 64, unsigned int threads = 0);
+
+		async_reader(const async_reader&) = delete;
+		async_reader& operator=(const async_reader&) = delete;
+
+		/// Waits for reads in flight, and breaks the promises of those not started
+		~async_reader();
+
+		/// If reads are currently done with io_uring, rather than threads
+		bool uses_io_uring() const;
+
+		/// Submit a batch of reads, errors are reported per request
+		std::future<std::vector<read_result>> read(std::vector<read_request> requests);
+
+	};
+
+} // namespace res
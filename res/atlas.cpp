@@ -0,0 +1,130 @@
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace res {
+
+	// class skyline_packer {{{
+
+	skyline_packer::skyline_packer(uint32_t width, uint32_t height)
+		: page_width(width), page_height(height), used_area(0), skyline()
+	{
+		this->reset();
+	}
+
+	void skyline_packer::reset()
+	{
+		skyline.clear();
+		skyline.push_back(segment{0, 0, page_width});
+		used_area = 0;
+	}
+
+	stx::optional<uint32_t> skyline_packer::fit(size_t idx, uint32_t w, uint32_t h) const
+	{
+		uint32_t x = skyline[idx].x;
+		if(x + w > page_width) {
+			return stx::nullopt;
+		}
+
+		// the rectangle rests on the highest segment it spans
+		uint32_t y = 0;
+		uint64_t width_left = w;
+		for(size_t i = idx; width_left > 0; ++i) {
+			// segments always cover the page width, so this does not overrun
+			y = std::max(y, skyline[i].y);
+			if(y + h > page_height) {
+				return stx::nullopt;
+			}
+			width_left -= std::min<uint64_t>(width_left, skyline[i].width);
+		}
+		return y;
+	}
+
+	void skyline_packer::place(size_t idx, const point& at, uint32_t w, uint32_t h)
+	{
+		skyline.insert(skyline.begin() + idx, segment{at.x, at.y + h, w});
+
+		// shrink or remove the segments now covered by the new one
+		for(size_t i = idx + 1; i < skyline.size(); ) {
+			const auto& prev = skyline[i - 1];
+			auto prev_end = prev.x + prev.width;
+			if(skyline[i].x >= prev_end) {
+				break;
+			}
+
+			auto overlap = prev_end - skyline[i].x;
+			if(overlap >= skyline[i].width) {
+				skyline.erase(skyline.begin() + i);
+			} else {
+				skyline[i].x += overlap;
+				skyline[i].width -= overlap;
+				break;
+			}
+		}
+
+		// merge neighbours of the same height
+		for(size_t i = 1; i < skyline.size(); ) {
+			if(skyline[i - 1].y == skyline[i].y) {
+				skyline[i - 1].width += skyline[i].width;
+				skyline.erase(skyline.begin() + i);
+			} else {
+				++i;
+			}
+		}
+
+		used_area += uint64_t(w) * h;
+	}
+
+	stx::optional<skyline_packer::point> skyline_packer::insert(uint32_t w, uint32_t h)
+	{
+		if(w == 0 || h == 0) {
+			return point{0, 0};
+		}
+
+		auto best_bottom = std::numeric_limits<uint32_t>::max();
+		auto best_width = std::numeric_limits<uint32_t>::max();
+		auto best_idx = skyline.size();
+		point best_at{0, 0};
+
+		for(size_t i = 0; i < skyline.size(); ++i) {
+			auto y = this->fit(i, w, h);
+			if(!y) {
+				continue;
+			}
+
+			auto bottom = *y + h;
+			if(bottom < best_bottom || (bottom == best_bottom && skyline[i].width < best_width)) {
+				best_bottom = bottom;
+				best_width = skyline[i].width;
+				best_idx = i;
+				best_at = point{skyline[i].x, *y};
+			}
+		}
+
+		if(best_idx == skyline.size()) {
+			return stx::nullopt;
+		}
+
+		this->place(best_idx, best_at, w, h);
+		return best_at;
+	}
+
+	uint32_t skyline_packer::width() const
+	{
+		return page_width;
+	}
+
+	uint32_t skyline_packer::height() const
+	{
+		return page_height;
+	}
+
+	double skyline_packer::occupancy() const
+	{
+		return double(used_area) / (double(page_width) * page_height);
+	}
+
+	// }}}
+
+} // namespace res
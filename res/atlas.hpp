@@ -0,0 +1,102 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "include/optional.hpp"
+
+/**
+ * \file
+ * \brief Texture atlas packing
+ *
+ * This provides the rectangle packer used by cvt-atlas to combine many images
+ * into a few large pages, as well as the type used for the generated sprite
+ * locations.
+ */
+
+namespace res {
+
+	/**
+	 * \struct atlas_rect
+	 * \brief Location of a sprite in a packed atlas
+	 *
+	 * These are generated by cvt-atlas. Since SFML uses pixel texture
+	 * coordinates, the rectangle can be directly used as the texture rect
+	 * of a sprite on the given page.
+	 */
+	struct atlas_rect
+	{
+		uint16_t page; ///< index of the atlas page
+		uint16_t left;
+		uint16_t top;
+		uint16_t width;
+		uint16_t height;
+	};
+
+	/**
+	 * \class skyline_packer
+	 * \brief Online rectangle packer for a single page
+	 *
+	 * This keeps track of the top edge (the "skyline") of all rectangles
+	 * placed so far, and places each new rectangle at the lowest position
+	 * it fits in. Ties are broken by the narrowest fitting segment, which
+	 * reduces wasted space.
+	 *
+	 * Rectangles are best inserted from tallest to shortest.
+	 */
+	class skyline_packer
+	{
+	public: // statics
+
+		struct point
+		{
+			uint32_t x;
+			uint32_t y;
+		};
+
+	private: // internal statics
+
+		// a horizontal segment of the skyline
+		struct segment
+		{
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+		};
+
+	private: // variables
+
+		uint32_t page_width;
+		uint32_t page_height;
+		uint64_t used_area;
+
+		std::vector<segment> skyline;
+
+	private: // internal methods
+
+		// find the y position for a rectangle with its left at segment idx
+		stx::optional<uint32_t> fit(size_t idx, uint32_t w, uint32_t h) const;
+
+		// place a rectangle at segment idx, updating the skyline
+		void place(size_t idx, const point& at, uint32_t w, uint32_t h);
+
+	public: // methods
+
+		skyline_packer(uint32_t width, uint32_t height);
+
+		/// Remove all placed rectangles
+		void reset();
+
+		/// Find a place for a w by h rectangle, or nullopt if it does not fit
+		stx::optional<point> insert(uint32_t w, uint32_t h);
+
+		uint32_t width() const;
+		uint32_t height() const;
+
+		/// Fraction of the page covered by placed rectangles
+		double occupancy() const;
+
+	};
+
+} // namespace res
@@ -0,0 +1,78 @@
+#include "cache.hpp"
+
+namespace res {
+
+	// class cache_budget {{{
+
+	cache_budget& cache_budget::instance()
+	{
+		static cache_budget global;
+		return global;
+	}
+
+	cache_budget::cache_budget(uint64_t init_budget)
+		: lru(), budget(init_budget), used(0), evictions(0), lock()
+	{
+	}
+
+	void cache_budget::set_budget(uint64_t new_budget)
+	{
+		evicted_list evicted;
+		std::lock_guard<std::mutex> guard(lock);
+		budget = new_budget;
+		this->evict_to(budget, evicted);
+	}
+
+	uint64_t cache_budget::get_budget()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return budget;
+	}
+
+	uint64_t cache_budget::get_used()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return used;
+	}
+
+	size_t cache_budget::get_evictions()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return evictions;
+	}
+
+	cache_budget::handle cache_budget::insert(cache_base* owner, const std::string& key, uint64_t cost, evicted_list& evicted)
+	{
+		// a resource larger than the budget is still cached, alone
+		this->evict_to(cost < budget ? budget - cost : 0, evicted);
+
+		lru.push_front(entry{owner, key, cost});
+		used += cost;
+		return lru.begin();
+	}
+
+	void cache_budget::erase(handle pos)
+	{
+		used -= pos->cost;
+		lru.erase(pos);
+	}
+
+	void cache_budget::touch(handle pos)
+	{
+		lru.splice(lru.begin(), lru, pos);
+	}
+
+	void cache_budget::evict_to(uint64_t target, evicted_list& evicted)
+	{
+		while(used > target && !lru.empty()) {
+			auto& oldest = lru.back();
+			used -= oldest.cost;
+			evicted.push_back(oldest.owner->drop(oldest.key));
+			lru.pop_back();
+			++evictions;
+		}
+	}
+
+	// }}}
+
+} // namespace res
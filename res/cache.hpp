@@ -0,0 +1,308 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "res/memfile.hpp"
+
+/**
+ * \file
+ * \brief Shared cache of decoded resources
+ *
+ * Decoded resources (textures, fonts, etc.) are kept in a res::cache for each
+ * type, and are looked up by name. All caches share one memory budget in
+ * res::cache_budget, and the least recently used resources of any type are
+ * dropped when it is exceeded. Decompressed blocks (see compressed.hpp) are
+ * charged to the same budget. This allows programs with many resources to
+ * stay within a fixed amount of memory.
+ */
+
+namespace res {
+
+	class cache_budget;
+
+	/**
+	 * \internal
+	 * \class cache_base
+	 * \brief Type-erased base of cache, for eviction
+	 */
+	class cache_base
+	{
+	protected: // methods
+
+		friend class cache_budget;
+
+		// called with the budget locked, returns the value to be destroyed after unlocking
+		virtual std::shared_ptr<void> drop(const std::string& key) = 0;
+
+		~cache_base() = default;
+
+	};
+
+	/**
+	 * \class cache_budget
+	 * \brief Memory budget shared by all caches
+	 *
+	 * This keeps every cached resource in one LRU list, with the cost of
+	 * each. The lock is shared by all caches, so they can be used from
+	 * multiple threads.
+	 */
+	class cache_budget
+	{
+	private: // statics
+
+		struct entry
+		{
+			cache_base* owner;
+			std::string key;
+			uint64_t cost;
+		};
+
+	public: // statics
+
+		using handle = std::list<entry>::iterator;
+
+		/**
+		 * Values taken out of the caches, which are only destroyed once the
+		 * lock is released, as destroying one may use a cache. Declare it
+		 * before the lock guard, so it is destroyed after it.
+		 */
+		using evicted_list = std::vector<std::shared_ptr<void>>;
+
+		/// The budget used by all caches
+		static cache_budget& instance();
+
+	private: // variables
+
+		std::list<entry> lru; // most recently used at the front
+
+		uint64_t budget;
+		uint64_t used;
+		size_t evictions;
+
+	public: // variables
+
+		std::mutex lock;
+
+	public: // methods
+
+		explicit cache_budget(uint64_t init_budget = 256 << 20);
+
+		cache_budget(const cache_budget&) = delete;
+		cache_budget& operator=(const cache_budget&) = delete;
+
+		/// Change the budget, evicting if it is now exceeded
+		void set_budget(uint64_t new_budget);
+		uint64_t get_budget();
+
+		/// Total cost of the cached resources
+		uint64_t get_used();
+		/// Number of resources dropped for the budget
+		size_t get_evictions();
+
+		// the following require the lock to be held
+
+		/// Add an entry, evicting others to make space
+		handle insert(cache_base* owner, const std::string& key, uint64_t cost, evicted_list& evicted);
+		void erase(handle pos);
+		void touch(handle pos);
+
+		/// Drop least recently used entries until at most \p target is used
+		void evict_to(uint64_t target, evicted_list& evicted);
+
+	};
+
+	/**
+	 * \class cache
+	 * \brief Cache of decoded resources of type \p T
+	 *
+	 * Resources are built on demand by the builder, from the block of
+	 * memory or mapped file given on a miss. The builder has the same
+	 * signature as the decode function in res::loader. Each resource has a
+	 * cost in bytes, which is by default the size of its source, or can be
+	 * given by a cost function (e.g. 4 bytes per pixel for textures).
+	 *
+	 * Resources are returned as shared pointers, so an evicted resource
+	 * stays alive as long as it is used. Building happens without the lock
+	 * held, so builders may use other caches.
+	 *
+	 * \warning
+	 * Types which keep referring to their source (e.g. sf::Font) must be
+	 * built from memory which stays valid, rather than with load().
+	 */
+	template <typename T>
+	class cache : private cache_base
+	{
+	public: // statics
+
+		using value_ptr = std::shared_ptr<T>;
+		using builder_type = std::function<T(const void*, uint64_t)>;
+		using cost_type = std::function<uint64_t(const T&, uint64_t)>;
+
+		struct statistics
+		{
+			size_t hits;
+			size_t misses;
+			size_t entries;
+		};
+
+	private: // statics
+
+		struct slot
+		{
+			value_ptr value;
+			cache_budget::handle pos;
+		};
+
+	private: // variables
+
+		cache_budget& budget;
+		builder_type builder;
+		cost_type cost;
+
+		std::unordered_map<std::string, slot> entries;
+		size_t hits;
+		size_t misses;
+
+	private: // internal methods
+
+		std::shared_ptr<void> drop(const std::string& key) override
+		{
+			auto it = entries.find(key);
+			if(it == entries.end()) {
+				return nullptr;
+			}
+			auto value = std::move(it->second.value);
+			entries.erase(it);
+			return value;
+		}
+
+		// requires the lock to be held
+		value_ptr lookup(const std::string& name)
+		{
+			auto it = entries.find(name);
+			if(it == entries.end()) {
+				return nullptr;
+			}
+			budget.touch(it->second.pos);
+			return it->second.value;
+		}
+
+		value_ptr build(const std::string& name, const void* addr, uint64_t size)
+		{
+			auto value = std::make_shared<T>(builder(addr, size));
+			auto value_cost = cost ? cost(*value, size) : size;
+
+			cache_budget::evicted_list evicted;
+			std::lock_guard<std::mutex> guard(budget.lock);
+			// another thread may have built it in the meantime
+			if(auto existing = this->lookup(name)) {
+				return existing;
+			}
+			auto pos = budget.insert(this, name, value_cost, evicted);
+			entries.emplace(name, slot{value, pos});
+			return value;
+		}
+
+	public: // methods
+
+		explicit cache(builder_type init_builder, cost_type init_cost = nullptr,
+		               cache_budget& init_budget = cache_budget::instance())
+			: budget(init_budget), builder(std::move(init_builder)), cost(std::move(init_cost))
+			, entries(), hits(0), misses(0)
+		{
+		}
+
+		cache(const cache&) = delete;
+		cache& operator=(const cache&) = delete;
+
+		~cache()
+		{
+			this->clear();
+		}
+
+		/**
+		 * \fn get
+		 * \brief Get a resource, building it from memory on a miss
+		 *
+		 * \p addr and \p size are only used on a miss.
+		 */
+		value_ptr get(const std::string& name, const void* addr, uint64_t size)
+		{
+			{
+				std::lock_guard<std::mutex> guard(budget.lock);
+				if(auto value = this->lookup(name)) {
+					++hits;
+					return value;
+				}
+				++misses;
+			}
+			return this->build(name, addr, size);
+		}
+
+		/// Same as above, for a resource with get() and size(), e.g. ro_memblk
+		template <typename R>
+		value_ptr get(const std::string& name, const R& res)
+		{
+			return this->get(name, res.get(), res.size());
+		}
+
+		/// Get a resource, keyed and built from a file, which is only mapped on a miss
+		value_ptr load(const std::string& filename)
+		{
+			{
+				std::lock_guard<std::mutex> guard(budget.lock);
+				if(auto value = this->lookup(filename)) {
+					++hits;
+					return value;
+				}
+				++misses;
+			}
+			ro_memfile file(filename.c_str());
+			return this->build(filename, file.get(), file.size());
+		}
+
+		/// Get a resource if it is cached, without counting a hit or miss
+		value_ptr find(const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(budget.lock);
+			return this->lookup(name);
+		}
+
+		void erase(const std::string& name)
+		{
+			value_ptr erased;
+			std::lock_guard<std::mutex> guard(budget.lock);
+			auto it = entries.find(name);
+			if(it != entries.end()) {
+				budget.erase(it->second.pos);
+				erased = std::move(it->second.value);
+				entries.erase(it);
+			}
+		}
+
+		void clear()
+		{
+			decltype(entries) erased;
+			std::lock_guard<std::mutex> guard(budget.lock);
+			for(auto& entry : entries) {
+				budget.erase(entry.second.pos);
+			}
+			erased.swap(entries);
+		}
+
+		statistics get_stats()
+		{
+			std::lock_guard<std::mutex> guard(budget.lock);
+			return statistics{hits, misses, entries.size()};
+		}
+
+	};
+
+} // namespace res
@@ -0,0 +1,156 @@
+#include "compressed.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "res/lz.hpp"
+
+namespace res {
+
+	// class decompress_cache {{{
+
+	decompress_cache& decompress_cache::instance()
+	{
+		static decompress_cache cache;
+		return cache;
+	}
+
+	decompress_cache::decompress_cache(cache_budget& init_budget)
+		: budget(init_budget), index(), stats{0, 0, 0, 0}
+	{
+	}
+
+	decompress_cache::~decompress_cache()
+	{
+		this->clear();
+	}
+
+	std::string decompress_cache::to_key(const void* src)
+	{
+		return std::to_string(reinterpret_cast<uintptr_t>(src));
+	}
+
+	std::shared_ptr<void> decompress_cache::drop(const std::string& key)
+	{
+		auto it = index.find(reinterpret_cast<const void*>(uintptr_t(std::stoull(key))));
+		if(it == index.end()) {
+			return nullptr;
+		}
+		auto data = std::move(it->second.data);
+		stats.used -= data->size();
+		++stats.evictions;
+		index.erase(it);
+		return std::const_pointer_cast<std::vector<uint8_t>>(data);
+	}
+
+	decompress_cache::statistics decompress_cache::get_stats()
+	{
+		std::lock_guard<std::mutex> guard(budget.lock);
+		return stats;
+	}
+
+	void decompress_cache::clear()
+	{
+		decltype(index) erased;
+		std::lock_guard<std::mutex> guard(budget.lock);
+		for(auto& entry : index) {
+			budget.erase(entry.second.pos);
+		}
+		erased.swap(index);
+		stats.used = 0;
+	}
+
+	decompress_cache::block_ptr decompress_cache::fetch(const void* src, uint64_t src_size)
+	{
+		{
+			std::lock_guard<std::mutex> guard(budget.lock);
+			auto it = index.find(src);
+			if(it != index.end()) {
+				++stats.hits;
+				budget.touch(it->second.pos);
+				return it->second.data;
+			}
+			++stats.misses;
+		}
+
+		// decompress without holding the lock, so other blocks can be fetched
+		auto data = std::make_shared<std::vector<uint8_t>>(lz_decompressed_size(src, src_size));
+		if(!lz_decompress(src, src_size, data->data(), data->size())) {
+			throw std::runtime_error("malformed compressed block");
+		}
+
+		cache_budget::evicted_list evicted;
+		std::lock_guard<std::mutex> guard(budget.lock);
+		auto it = index.find(src);
+		if(it != index.end()) {
+			// another thread got here first
+			budget.touch(it->second.pos);
+			return it->second.data;
+		}
+
+		auto pos = budget.insert(this, to_key(src), data->size(), evicted);
+		index.emplace(src, slot{data, pos});
+		stats.used += data->size();
+
+		return data;
+	}
+
+	// }}}
+
+	// class compressed_memblk {{{
+
+	compressed_memblk::compressed_memblk()
+		: source(), blk_size(0)
+	{
+	}
+
+	compressed_memblk::compressed_memblk(const void* addr_init, uint64_t size_init)
+		: compressed_memblk()
+	{
+		this->open(addr_init, size_init);
+	}
+
+	void compressed_memblk::open(const void* addr_init, uint64_t size_init)
+	{
+		source.open(addr_init, size_init);
+		blk_size = lz_decompressed_size(addr_init, size_init);
+	}
+
+	bool compressed_memblk::is_open() const
+	{
+		return source.is_open();
+	}
+
+	void compressed_memblk::close()
+	{
+		source.close();
+		blk_size = 0;
+	}
+
+	decompress_cache::block_ptr compressed_memblk::get() const
+	{
+		if(!this->is_open()) {
+			return nullptr;
+		}
+		return decompress_cache::instance().fetch(source.get(), source.size());
+	}
+
+	const void* compressed_memblk::unsafe_get() const
+	{
+		auto block = this->get();
+		return block ? block->data() : nullptr;
+	}
+
+	uint64_t compressed_memblk::size() const
+	{
+		return blk_size;
+	}
+
+	uint64_t compressed_memblk::compressed_size() const
+	{
+		return source.size();
+	}
+
+	// }}}
+
+} // namespace res
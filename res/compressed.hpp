@@ -0,0 +1,157 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/types.hpp"
+#include "res/cache.hpp"
+#include "res/memblk.hpp"
+
+namespace res {
+
+	/**
+	 * \class decompress_cache
+	 * \brief Cache of decompressed blocks, in the shared budget
+	 *
+	 * This holds the decompressed contents of compressed_memblk objects,
+	 * keyed by the address of the compressed data. Their sizes are charged
+	 * to a cache_budget (see cache.hpp), the same as decoded resources, so
+	 * decompressed and decoded data share one memory limit, and the least
+	 * recently used of either are dropped when it is exceeded.
+	 *
+	 * Blocks are reference counted, so a dropped block stays alive as long
+	 * as something is still holding it from fetch(). Only the blocks held
+	 * by the cache count towards the budget.
+	 *
+	 * This is thread safe.
+	 */
+	class decompress_cache : private cache_base
+	{
+	public: // statics
+
+		using block_ptr = std::shared_ptr<const std::vector<uint8_t>>;
+
+		struct statistics
+		{
+			uint64_t hits;
+			uint64_t misses;
+			uint64_t evictions;
+			uint64_t used; ///< bytes currently cached
+		};
+
+		/// Cache used by compressed_memblk
+		static decompress_cache& instance();
+
+	private: // internal statics
+
+		struct slot
+		{
+			block_ptr data;
+			cache_budget::handle pos;
+		};
+
+	private: // variables
+
+		cache_budget& budget;
+
+		std::unordered_map<const void*, slot> index;
+		statistics stats;
+
+	private: // internal methods
+
+		// keys in the budget are the address of the compressed data
+		static std::string to_key(const void* src);
+
+		std::shared_ptr<void> drop(const std::string& key) override;
+
+	public: // methods
+
+		explicit decompress_cache(cache_budget& init_budget = cache_budget::instance());
+
+		decompress_cache(const decompress_cache&) = delete;
+		decompress_cache& operator=(const decompress_cache&) = delete;
+
+		~decompress_cache();
+
+		statistics get_stats();
+
+		/// Drop all cached blocks
+		void clear();
+
+		/**
+		 * \fn fetch
+		 * \brief Get the decompressed contents of a block
+		 *
+		 * This decompresses \p src if it is not already cached. Throws
+		 * std::runtime_error if the compressed data is malformed.
+		 */
+		block_ptr fetch(const void* src, uint64_t src_size);
+
+	};
+
+	/**
+	 * \class compressed_memblk
+	 * \brief Readable memory block with lazy decompression
+	 *
+	 * This is a stand-in for ro_memblk for blocks compressed by cvt-export.
+	 * The block is only decompressed on first access, and the result is
+	 * kept in decompress_cache::instance().
+	 *
+	 * Unlike ro_memblk, get() returns a handle to the contents, which keeps
+	 * them alive while it is held, since the cache may evict the block at
+	 * any time (e.g. on another thread). APIs which keep the pointer, such
+	 * as sf::Font::loadFromMemory, need the handle held as long as they do.
+	 */
+	class compressed_memblk
+	{
+	private: // variables
+
+		ro_memblk source;
+		uint64_t blk_size;
+
+	public: // methods
+
+		compressed_memblk();
+		compressed_memblk(const void* addr_init, uint64_t size_init);
+
+		template <uint64_t N>
+		compressed_memblk(byte_block<N>& block)
+			: compressed_memblk()
+		{
+			this->open(block);
+		}
+
+		void open(const void* addr_init, uint64_t size_init);
+
+		template <uint64_t N>
+		void open(byte_block<N>& block)
+		{
+			this->open(static_cast<const void*>(&block[0]), N);
+		}
+
+		bool is_open() const;
+		void close();
+
+		/// Decompressed contents, kept alive while the handle is held
+		decompress_cache::block_ptr get() const;
+
+		/**
+		 * \fn unsafe_get
+		 * \brief Pointer to the decompressed contents, without holding them
+		 *
+		 * The pointer is only valid until the block is evicted from the
+		 * cache, which can happen on any later fetch, including on another
+		 * thread. Only use it for a read which nothing else can overlap.
+		 */
+		const void* unsafe_get() const;
+
+		uint64_t size() const;
+
+		uint64_t compressed_size() const;
+
+	};
+
+} // namespace res
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "config.hpp"
 #include "include/preproc.hpp"
 
 // define EXPORTS if you want to compile to a dll
-#ifdef EXPORTS
+#if !defined(PLATFORM_WIN32)
+	// shared objects export by default, and need no import library
+	#define _dll_api_ extern __attribute__((visibility("default")))
+	#define _dll_lib_(f) /* nil */
+#elif defined(EXPORTS)
 	// create dll
 	#define _dll_api_ extern __declspec(dllexport)
 	#define _dll_lib_(f) /* nil */
@@ -0,0 +1,23 @@
+#include "glyphs.hpp"
+
+#include <algorithm>
+
+namespace res {
+
+	// struct glyph_set {{{
+
+	const glyph_info* glyph_set::find(uint32_t codepoint) const
+	{
+		auto last = glyphs + count;
+		auto it = std::lower_bound(glyphs, last, codepoint, [] (const glyph_info& g, uint32_t cp) {
+				return g.codepoint < cp;
+			});
+		if(it == last || it->codepoint != codepoint) {
+			return nullptr;
+		}
+		return it;
+	}
+
+	// }}}
+
+} // namespace res
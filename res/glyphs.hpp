@@ -0,0 +1,55 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "res/atlas.hpp"
+
+/**
+ * \file
+ * \brief Prebaked glyph metrics
+ *
+ * These are the types of the metrics tables generated by cvt-glyphs. Together
+ * with the glyph atlas page, they are enough to lay out and draw text without
+ * a font rasteriser. See disp::glyph_text for drawing.
+ */
+
+namespace res {
+
+	/**
+	 * \struct glyph_info
+	 * \brief Metrics and atlas location of a single glyph
+	 *
+	 * The bounds are relative to the baseline at the pen position, in the
+	 * same way as sf::Glyph.
+	 */
+	struct glyph_info
+	{
+		uint32_t codepoint;
+		float advance; ///< horizontal offset to the next glyph
+		float left;
+		float top;
+		float width;
+		float height;
+		atlas_rect rect; ///< location in the glyph atlas
+	};
+
+	/**
+	 * \struct glyph_set
+	 * \brief All baked glyphs of a font at one character size
+	 *
+	 * The glyphs are sorted by codepoint.
+	 */
+	struct glyph_set
+	{
+		unsigned int size; ///< character size, in pixels
+		float line_spacing;
+		const glyph_info* glyphs;
+		size_t count;
+
+		/// Find a glyph, or nullptr if it was not baked
+		const glyph_info* find(uint32_t codepoint) const;
+	};
+
+} // namespace res
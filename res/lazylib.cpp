@@ -0,0 +1,97 @@
+#include "lazylib.hpp"
+
+#include <stdexcept>
+
+#include "config.hpp"
+
+#if defined(PLATFORM_WIN32)
+	#include "include/win32.hpp"
+#else
+	#include <climits>
+	#include <dlfcn.h>
+	#include <unistd.h>
+#endif
+
+namespace { // anonymous
+
+	std::string executable_dir()
+	{
+#if defined(PLATFORM_WIN32)
+		// LoadLibrary already looks beside the executable first
+		return std::string();
+#elif defined(PLATFORM_LINUX)
+		char path[PATH_MAX];
+		auto len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+		if(len <= 0) {
+			return std::string();
+		}
+		std::string exe(path, size_t(len));
+		return exe.substr(0, exe.find_last_of('/') + 1);
+#else
+		return std::string();
+#endif
+	}
+
+} // namespace anonymous
+
+namespace res {
+
+	// class lazy_library {{{
+
+	lazy_library::lazy_library(const char* init_filename, const char* init_lookup_name)
+		: filename(init_filename), lookup_name(init_lookup_name), once(), handle(nullptr), lookup(nullptr)
+	{
+	}
+
+	void lazy_library::open()
+	{
+#if defined(PLATFORM_WIN32)
+		auto module = LoadLibraryA(filename.c_str());
+		if(!module) {
+			throw std::runtime_error(filename + ": cannot load library");
+		}
+		handle = module;
+		lookup = reinterpret_cast<lookup_fn>(GetProcAddress(module, lookup_name.c_str()));
+		if(!lookup) {
+			// the next call loads it again, so do not leak this reference
+			FreeLibrary(module);
+			handle = nullptr;
+		}
+#else
+		auto dir = executable_dir();
+		if(!dir.empty()) {
+			handle = dlopen((dir + filename).c_str(), RTLD_NOW | RTLD_LOCAL);
+		}
+		if(!handle) {
+			handle = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+		}
+		if(!handle) {
+			throw std::runtime_error(dlerror());
+		}
+		lookup = reinterpret_cast<lookup_fn>(dlsym(handle, lookup_name.c_str()));
+		if(!lookup) {
+			// the next call loads it again, so do not leak this reference
+			dlclose(handle);
+			handle = nullptr;
+		}
+#endif
+		if(!lookup) {
+			throw std::runtime_error(filename + ": no symbol " + lookup_name);
+		}
+	}
+
+	const void* lazy_library::find(const char* name, uint64_t& size)
+	{
+		// if open() throws, the next call tries again
+		std::call_once(once, [this] { this->open(); });
+
+		auto addr = lookup(name, &size);
+		if(!addr) {
+			throw std::runtime_error(filename + ": no resource " + name);
+		}
+		return addr;
+	}
+
+	// }}}
+
+} // namespace res
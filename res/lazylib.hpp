@@ -0,0 +1,144 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "res/compressed.hpp"
+#include "res/memblk.hpp"
+
+/**
+ * \file
+ * \brief Lazily loaded resource libraries
+ *
+ * Normally a program is linked with its resource library (see cvt-export),
+ * which is loaded and relocated at startup. In lazy mode, cvt-wrapper
+ * instead generates res::lazy_block wrappers, and the library is only
+ * loaded when one is first used. This helps programs which only use a few
+ * of many resources.
+ */
+
+namespace res {
+
+	/**
+	 * \class lazy_library
+	 * \brief Resource library loaded on first use
+	 *
+	 * The library is looked for beside the executable, then in the usual
+	 * places. Blocks are found through the lookup function exported by
+	 * cvt-export, which also resolves files that share contents.
+	 */
+	class lazy_library
+	{
+	private: // statics
+
+		using lookup_fn = const uint8_t* (*)(const char* name, uint64_t* size);
+
+	private: // variables
+
+		std::string filename;
+		std::string lookup_name;
+
+		std::once_flag once;
+		void* handle;
+		lookup_fn lookup;
+
+	private: // internal methods
+
+		void open();
+
+	public: // methods
+
+		lazy_library(const char* init_filename, const char* init_lookup_name);
+
+		lazy_library(const lazy_library&) = delete;
+		lazy_library& operator=(const lazy_library&) = delete;
+
+		// the library is left loaded, as blocks may still be in use at exit
+
+		/**
+		 * \fn find
+		 * \brief Find a block in the library, loading it if needed
+		 *
+		 * Throws std::runtime_error if the library or block cannot be
+		 * found. This is thread-safe.
+		 */
+		const void* find(const char* name, uint64_t& size);
+
+	};
+
+	/**
+	 * \class lazy_block
+	 * \brief Block in a lazy_library
+	 *
+	 * This opens a \p T (ro_memblk or compressed_memblk) from the library
+	 * on first use. After that, access is only an extra atomic load.
+	 */
+	template <typename T>
+	class lazy_block
+	{
+	private: // variables
+
+		lazy_library& library;
+		const char* name;
+
+		mutable std::once_flag once;
+		mutable std::atomic<bool> ready;
+		mutable T block;
+
+	private: // internal methods
+
+		const T& resolve() const
+		{
+			if(!ready.load(std::memory_order_acquire)) {
+				std::call_once(once, [this] {
+						uint64_t size = 0;
+						auto addr = library.find(name, size);
+						block.open(addr, size);
+						ready.store(true, std::memory_order_release);
+					});
+			}
+			return block;
+		}
+
+	public: // methods
+
+		/// \p init_name must be a string literal, or otherwise outlive this
+		lazy_block(lazy_library& init_library, const char* init_name)
+			: library(init_library), name(init_name), once(), ready(false), block()
+		{
+		}
+
+		lazy_block(const lazy_block&) = delete;
+		lazy_block& operator=(const lazy_block&) = delete;
+
+		const T& operator*() const
+		{
+			return this->resolve();
+		}
+
+		const T* operator->() const
+		{
+			return &this->resolve();
+		}
+
+		/// Same as T::get(), so a handle for compressed_memblk
+		auto get() const -> decltype(std::declval<const T&>().get())
+		{
+			return this->resolve().get();
+		}
+
+		uint64_t size() const
+		{
+			return this->resolve().size();
+		}
+
+	};
+
+	using lazy_memblk = lazy_block<ro_memblk>;
+	using lazy_compressed_memblk = lazy_block<compressed_memblk>;
+
+} // namespace res
@@ -0,0 +1,101 @@
+#include "loader.hpp"
+
+#include <algorithm>
+
+namespace res {
+
+	// class loader {{{
+
+	loader::loader(unsigned int threads)
+		: workers(), queue_lock(), queue_cv(), pending(), stopping(false)
+		, done_lock(), done_callbacks(), completed_count(0), total_count(0)
+	{
+		if(threads == 0) {
+			// leave a core for the main thread
+			auto cores = std::thread::hardware_concurrency();
+			threads = std::max(1u, cores > 1 ? cores - 1 : 1u);
+		}
+
+		for(unsigned int i = 0; i < threads; ++i) {
+			workers.emplace_back([this] { this->worker_loop(); });
+		}
+	}
+
+	loader::~loader()
+	{
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			stopping = true;
+			// destroying the jobs breaks their promises
+			pending.clear();
+		}
+		queue_cv.notify_all();
+
+		for(auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	void loader::worker_loop()
+	{
+		while(true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(queue_lock);
+				queue_cv.wait(lock, [this] { return stopping || !pending.empty(); });
+				if(stopping) {
+					return;
+				}
+				job = std::move(pending.front());
+				pending.pop_front();
+			}
+
+			// exceptions are caught by the packaged_task
+			job();
+			++completed_count;
+		}
+	}
+
+	void loader::enqueue(std::function<void()> job)
+	{
+		++total_count;
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			pending.push_back(std::move(job));
+		}
+		queue_cv.notify_one();
+	}
+
+	void loader::enqueue_done(std::function<void()> callback)
+	{
+		std::lock_guard<std::mutex> guard(done_lock);
+		done_callbacks.push_back(std::move(callback));
+	}
+
+	void loader::poll()
+	{
+		std::vector<std::function<void()>> callbacks;
+		{
+			std::lock_guard<std::mutex> guard(done_lock);
+			callbacks.swap(done_callbacks);
+		}
+
+		// run without the lock, so callbacks can start new loads
+		for(auto& callback : callbacks) {
+			callback();
+		}
+	}
+
+	loader::progress_info loader::progress() const
+	{
+		return progress_info{completed_count.load(), total_count.load()};
+	}
+
+	bool loader::done() const
+	{
+		return completed_count.load() == total_count.load();
+	}
+
+	// }}}
+
+} // namespace res
@@ -0,0 +1,176 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "res/memfile.hpp"
+
+namespace res {
+
+	/**
+	 * \class loader
+	 * \brief Background resource loader
+	 *
+	 * This reads and decodes resources on worker threads, so the program
+	 * can keep running (e.g. show a window) while they load. Files are
+	 * memory-mapped with ro_memfile, and passed to a decode function along
+	 * with their size.
+	 *
+	 * Results are available through a std::future, or through a callback
+	 * which is given the (ready) future. Callbacks are run in poll(), which
+	 * should be called regularly from the main loop, e.g. in rt::on_frame.
+	 * This allows callbacks to do things which must happen on the main
+	 * thread, like creating textures.
+	 *
+	 * Exceptions (from opening the file or decoding) are stored in the
+	 * future.
+	 */
+	class loader
+	{
+	public: // statics
+
+		struct progress_info
+		{
+			size_t completed;
+			size_t total;
+		};
+
+	private: // variables
+
+		std::vector<std::thread> workers;
+
+		std::mutex queue_lock;
+		std::condition_variable queue_cv;
+		std::deque<std::function<void()>> pending;
+		bool stopping;
+
+		std::mutex done_lock;
+		std::vector<std::function<void()>> done_callbacks;
+
+		std::atomic<size_t> completed_count;
+		std::atomic<size_t> total_count;
+
+	private: // internal methods
+
+		void worker_loop();
+
+		void enqueue(std::function<void()> job);
+		void enqueue_done(std::function<void()> callback);
+
+		template <typename F>
+		static auto file_job(std::string filename, F decode)
+		{
+			return [fname = std::move(filename), fn = std::move(decode)] () mutable {
+				ro_memfile file(fname.c_str());
+				return fn(static_cast<const void*>(file.get()), file.size());
+			};
+		}
+
+		template <typename F>
+		static auto block_job(const void* addr, uint64_t size, F decode)
+		{
+			return [addr, size, fn = std::move(decode)] () mutable {
+				return fn(addr, size);
+			};
+		}
+
+		template <typename J>
+		auto submit(J job)
+		{
+			using result_type = decltype(job());
+
+			auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(job));
+			auto result = task->get_future();
+			this->enqueue([task] { (*task)(); });
+			return result;
+		}
+
+		template <typename J, typename C>
+		void submit(J job, C callback)
+		{
+			using result_type = decltype(job());
+
+			auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(job));
+			auto result = std::make_shared<std::future<result_type>>(task->get_future());
+			auto fn = std::make_shared<C>(std::move(callback));
+			this->enqueue([this, task, result, fn] {
+					(*task)();
+					this->enqueue_done([result, fn] { (*fn)(std::move(*result)); });
+				});
+		}
+
+	public: // methods
+
+		/// Create a loader, with a worker per spare core if 0
+		explicit loader(unsigned int threads = 0);
+
+		loader(const loader&) = delete;
+		loader& operator=(const loader&) = delete;
+
+		/// Stops the workers, discarding loads which have not started
+		~loader();
+
+		/**
+		 * \fn load
+		 * \brief Load and decode a file in the background
+		 *
+		 * \p decode is called on a worker thread, with the mapped file
+		 * contents and size. The file is unmapped after it returns.
+		 */
+		template <typename F>
+		auto load(std::string filename, F decode)
+			-> std::future<decltype(decode(static_cast<const void*>(nullptr), uint64_t()))>
+		{
+			return this->submit(file_job(std::move(filename), std::move(decode)));
+		}
+
+		/// Same as load(), but calls \p callback with the ready future from poll()
+		template <typename F, typename C>
+		void load(std::string filename, F decode, C callback)
+		{
+			this->submit(file_job(std::move(filename), std::move(decode)), std::move(callback));
+		}
+
+		/**
+		 * \fn load_block
+		 * \brief Decode an existing block of memory in the background
+		 *
+		 * This is the same as load(), but for resources already in
+		 * memory (e.g. ro_memblk). The memory must stay valid until
+		 * the load is complete.
+		 */
+		template <typename F>
+		auto load_block(const void* addr, uint64_t size, F decode)
+			-> std::future<decltype(decode(addr, size))>
+		{
+			return this->submit(block_job(addr, size, std::move(decode)));
+		}
+
+		/// Same as load_block(), but calls \p callback with the ready future from poll()
+		template <typename F, typename C>
+		void load_block(const void* addr, uint64_t size, F decode, C callback)
+		{
+			this->submit(block_job(addr, size, std::move(decode)), std::move(callback));
+		}
+
+		/// Run callbacks of completed loads, on the calling thread
+		void poll();
+
+		/// Number of decoded and total jobs, callbacks may still be waiting for poll()
+		progress_info progress() const;
+
+		/// If all jobs are complete
+		bool done() const;
+
+	};
+
+} // namespace res
@@ -0,0 +1,197 @@
+#include "lz.hpp"
+
+#include <cstring>
+
+namespace { // anonymous
+
+	constexpr uint64_t header_size = 8;
+	constexpr uint64_t min_match = 4;
+	constexpr uint64_t max_offset = 0xffff;
+	constexpr int hash_bits = 16;
+
+	// most a compressed byte can expand to, from a match length byte of 255
+	constexpr uint64_t max_expansion = 256;
+
+	uint32_t read32(const uint8_t* p)
+	{
+		uint32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	uint32_t hash4(const uint8_t* p)
+	{
+		return (read32(p) * 2654435761u) >> (32 - hash_bits);
+	}
+
+	void write_length(std::vector<uint8_t>& out, uint64_t len)
+	{
+		// only the part over 15 is written here
+		len -= 15;
+		while(len >= 255) {
+			out.push_back(255);
+			len -= 255;
+		}
+		out.push_back(uint8_t(len));
+	}
+
+	void write_sequence(std::vector<uint8_t>& out, const uint8_t* lit, uint64_t lit_len,
+	                    uint64_t match_len, uint64_t offset)
+	{
+		uint64_t match_code = match_len ? match_len - min_match : 0;
+		uint8_t token = uint8_t((lit_len < 15 ? lit_len : 15) << 4)
+			| uint8_t(match_code < 15 ? match_code : 15);
+		out.push_back(token);
+
+		if(lit_len >= 15) {
+			write_length(out, lit_len);
+		}
+		out.insert(out.end(), lit, lit + lit_len);
+
+		if(match_len) {
+			out.push_back(uint8_t(offset & 0xff));
+			out.push_back(uint8_t(offset >> 8));
+			if(match_code >= 15) {
+				write_length(out, match_code);
+			}
+		}
+	}
+
+	// reads an extended length, returns false on overrun
+	bool read_length(const uint8_t*& p, const uint8_t* end, uint64_t& len)
+	{
+		uint8_t byte;
+		do {
+			if(p == end) {
+				return false;
+			}
+			byte = *p++;
+			len += byte;
+		} while(byte == 255);
+		return true;
+	}
+
+} // namespace anonymous
+
+namespace res {
+
+	std::vector<uint8_t> lz_compress(const void* src, uint64_t src_size)
+	{
+		auto in = static_cast<const uint8_t*>(src);
+
+		std::vector<uint8_t> out;
+		out.reserve(header_size + src_size / 2);
+		for(uint64_t i = 0; i < header_size; ++i) {
+			out.push_back(uint8_t(src_size >> (8 * i)));
+		}
+
+		// most recent position of each hashed 4 byte sequence
+		std::vector<uint64_t> table(uint64_t(1) << hash_bits, ~uint64_t(0));
+
+		uint64_t anchor = 0; // start of pending literals
+		uint64_t pos = 0;
+		while(pos + min_match <= src_size) {
+			auto h = hash4(in + pos);
+			auto candidate = table[h];
+			table[h] = pos;
+
+			if(candidate == ~uint64_t(0) || pos - candidate > max_offset
+			   || read32(in + candidate) != read32(in + pos)) {
+				++pos;
+				continue;
+			}
+
+			uint64_t len = min_match;
+			while(pos + len < src_size && in[candidate + len] == in[pos + len]) {
+				++len;
+			}
+
+			write_sequence(out, in + anchor, pos - anchor, len, pos - candidate);
+			pos += len;
+			anchor = pos;
+		}
+
+		write_sequence(out, in + anchor, src_size - anchor, 0, 0);
+		return out;
+	}
+
+	uint64_t lz_decompressed_size(const void* src, uint64_t src_size)
+	{
+		if(src_size < header_size) {
+			return 0;
+		}
+		auto in = static_cast<const uint8_t*>(src);
+		uint64_t size = 0;
+		for(uint64_t i = 0; i < header_size; ++i) {
+			size |= uint64_t(in[i]) << (8 * i);
+		}
+		if(size / max_expansion > src_size - header_size) {
+			return 0;
+		}
+		return size;
+	}
+
+	bool lz_decompress(const void* src, uint64_t src_size, void* dst, uint64_t dst_size)
+	{
+		auto expected = lz_decompressed_size(src, src_size);
+		if(src_size < header_size || dst_size < expected) {
+			return false;
+		}
+
+		auto ip = static_cast<const uint8_t*>(src) + header_size;
+		auto in_end = static_cast<const uint8_t*>(src) + src_size;
+		auto op = static_cast<uint8_t*>(dst);
+		auto out_begin = op;
+		auto out_end = op + expected;
+
+		while(ip != in_end) {
+			uint8_t token = *ip++;
+
+			uint64_t lit_len = token >> 4;
+			if(lit_len == 15 && !read_length(ip, in_end, lit_len)) {
+				return false;
+			}
+			if(lit_len > uint64_t(in_end - ip) || lit_len > uint64_t(out_end - op)) {
+				return false;
+			}
+			std::memcpy(op, ip, lit_len);
+			ip += lit_len;
+			op += lit_len;
+
+			if(ip == in_end) {
+				// last sequence has no match
+				break;
+			}
+
+			if(in_end - ip < 2) {
+				return false;
+			}
+			uint64_t offset = uint64_t(ip[0]) | (uint64_t(ip[1]) << 8);
+			ip += 2;
+
+			uint64_t match_len = token & 0xf;
+			if(match_len == 15 && !read_length(ip, in_end, match_len)) {
+				return false;
+			}
+			match_len += min_match;
+
+			if(offset == 0 || offset > uint64_t(op - out_begin) || match_len > uint64_t(out_end - op)) {
+				return false;
+			}
+
+			// a match can overlap its own output, which needs a byte-wise copy
+			auto match = op - offset;
+			if(offset >= match_len) {
+				std::memcpy(op, match, match_len);
+				op += match_len;
+			} else {
+				for(uint64_t i = 0; i < match_len; ++i) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		return op == out_end;
+	}
+
+} // namespace res
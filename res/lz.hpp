@@ -0,0 +1,46 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file
+ * \brief Self-contained LZ77 codec
+ *
+ * This is a small byte-oriented LZ77 compressor, used by cvt-export for
+ * compressed resources. It favours decompression speed over ratio.
+ *
+ * A compressed block starts with the decompressed size (8 bytes, little
+ * endian), followed by a series of sequences. Each sequence has a token byte
+ * (literal length in the high nibble, match length - 4 in the low nibble),
+ * extra length bytes if either nibble is 15, the literals, then a 2 byte
+ * little endian match offset. The last sequence has only literals.
+ */
+
+namespace res {
+
+	/// Compress a block of memory
+	std::vector<uint8_t> lz_compress(const void* src, uint64_t src_size);
+
+	/**
+	 * \fn lz_decompressed_size
+	 * \brief Get the decompressed size of a compressed block
+	 *
+	 * This returns 0 if the block is too small, or if the size in the header
+	 * is more than the rest of the block could decompress to, so a corrupt
+	 * header can't cause a huge allocation.
+	 */
+	uint64_t lz_decompressed_size(const void* src, uint64_t src_size);
+
+	/**
+	 * \fn lz_decompress
+	 * \brief Decompress a block of memory
+	 *
+	 * \p dst must be at least lz_decompressed_size() bytes. This returns
+	 * false if the compressed data is malformed, never reading or writing
+	 * out of bounds.
+	 */
+	bool lz_decompress(const void* src, uint64_t src_size, void* dst, uint64_t dst_size);
+
+} // namespace res
@@ -4,7 +4,17 @@
 #include <memory>
 #include <system_error>
 
-#include "include/win32.hpp"
+#include "config.hpp"
+
+#if defined(PLATFORM_WIN32)
+	#include "include/win32.hpp"
+#else
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 
 namespace res {
 
@@ -31,6 +41,8 @@ namespace res {
 		this->close();
 	}
 
+#if defined(PLATFORM_WIN32)
+
 	bool ro_memfile::open(const char* filename, std::error_code& ec)
 		noexcept
 	{
@@ -82,6 +94,53 @@ namespace res {
 		return true;
 	}
 
+#else
+
+	bool ro_memfile::open(const char* filename, std::error_code& ec)
+		noexcept
+	{
+		this->close();
+
+		auto fail = [&] {
+			ec.assign(errno, std::system_category());
+			return false;
+		};
+
+		// the mapping stays valid after the file is closed, so we
+		// don't keep the descriptor around
+		int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+		if(fd == -1) {
+			return fail();
+		}
+		using raii_fd = std::unique_ptr<int, void(*)(int*)>;
+		raii_fd fd_hdl{&fd, [] (int* f) { ::close(*f); }};
+
+		// get memory section size
+		struct stat st;
+		if(fstat(fd, &st) == -1) {
+			return fail();
+		}
+		if(st.st_size == 0) {
+			// consistent with windows, which can't map empty files
+			errno = EINVAL;
+			return fail();
+		}
+
+		// get memory section
+		void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		if(addr == MAP_FAILED) {
+			return fail();
+		}
+
+		// all are successful
+		ec.clear();
+		view = addr;
+		file_size = static_cast<uint64_t>(st.st_size);
+		return true;
+	}
+
+#endif
+
 	void ro_memfile::open(const char* filename)
 	{
 		std::error_code ec;
@@ -98,12 +157,18 @@ namespace res {
 	void ro_memfile::close()
 	{
 		if(this->is_open()) {
+#if defined(PLATFORM_WIN32)
 			UnmapViewOfFile(view);
 			view = nullptr;
 			CloseHandle(mapping);
 			mapping = nullptr;
 			CloseHandle(file);
 			file = nullptr;
+#else
+			munmap(view, static_cast<size_t>(file_size));
+			view = nullptr;
+#endif
+			file_size = 0;
 		}
 	}
 
@@ -11,6 +11,8 @@ namespace res {
 	 * \brief Read-only memory-mapped file
 	 *
 	 * This provides a way to access files as if they were loaded in memory.
+	 * On windows this uses a file mapping, and mmap elsewhere (where the
+	 * file and mapping handles are not needed, and so are left null).
 	 */
 	class ro_memfile
 	{
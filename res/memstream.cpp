@@ -0,0 +1,105 @@
+#include "memstream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace res {
+
+	// class memstream {{{
+
+	memstream::memstream()
+		: data(nullptr), length(0), position(0), held()
+	{
+	}
+
+	memstream::memstream(const void* addr_init, uint64_t size_init)
+		: memstream()
+	{
+		this->open(addr_init, size_init);
+	}
+
+	memstream::memstream(const ro_memblk& blk)
+		: memstream()
+	{
+		this->open(blk);
+	}
+
+	memstream::memstream(const ro_memfile& file)
+		: memstream()
+	{
+		this->open(file);
+	}
+
+	memstream::memstream(const compressed_memblk& blk)
+		: memstream()
+	{
+		this->open(blk);
+	}
+
+	memstream::~memstream() = default;
+
+	void memstream::open(const void* addr_init, uint64_t size_init)
+	{
+		data = static_cast<const uint8_t*>(addr_init);
+		length = size_init;
+		position = 0;
+		held.reset();
+	}
+
+	void memstream::open(const ro_memblk& blk)
+	{
+		this->open(blk.get(), blk.size());
+	}
+
+	void memstream::open(const ro_memfile& file)
+	{
+		this->open(file.get(), file.size());
+	}
+
+	void memstream::open(const compressed_memblk& blk)
+	{
+		auto block = blk.get();
+		if(block) {
+			this->open(block->data(), block->size());
+		} else {
+			this->open(nullptr, 0);
+		}
+		held = std::move(block);
+	}
+
+	sf::Int64 memstream::read(void* dest, sf::Int64 size)
+	{
+		if(!data || size < 0) {
+			return -1;
+		}
+
+		auto count = std::min<uint64_t>(uint64_t(size), length - position);
+		std::memcpy(dest, data + position, count);
+		position += count;
+		return sf::Int64(count);
+	}
+
+	sf::Int64 memstream::seek(sf::Int64 pos)
+	{
+		if(!data || pos < 0) {
+			return -1;
+		}
+
+		// same as sf::MemoryInputStream, clamp to the end
+		position = std::min<uint64_t>(uint64_t(pos), length);
+		return sf::Int64(position);
+	}
+
+	sf::Int64 memstream::tell()
+	{
+		return data ? sf::Int64(position) : -1;
+	}
+
+	sf::Int64 memstream::getSize()
+	{
+		return data ? sf::Int64(length) : -1;
+	}
+
+	// }}}
+
+} // namespace res
@@ -0,0 +1,76 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <sfml/system/inputstream.hpp>
+
+#include "res/compressed.hpp"
+#include "res/lazylib.hpp"
+#include "res/memblk.hpp"
+#include "res/memfile.hpp"
+
+namespace res {
+
+	/**
+	 * \class memstream
+	 * \brief SFML input stream over a resource
+	 *
+	 * This allows SFML to stream from a resource (e.g. with
+	 * sf::Music::openFromStream or sf::Font::loadFromStream), instead of
+	 * being handed the whole block with loadFromMemory. Reads are copied
+	 * directly out of the memory, so with ro_memfile only the pages which
+	 * are actually read need to be loaded.
+	 *
+	 * The stream does not own the memory, and the resource must outlive it
+	 * (and anything streaming from it, such as sf::Music). The exception
+	 * is compressed_memblk, where the decompressed block is held by the
+	 * stream.
+	 */
+	class memstream
+		: public sf::InputStream
+	{
+	private: // variables
+
+		const uint8_t* data;
+		uint64_t length;
+		uint64_t position;
+
+		// keeps a decompressed block alive
+		decompress_cache::block_ptr held;
+
+	public: // methods
+
+		memstream();
+		memstream(const void* addr_init, uint64_t size_init);
+		explicit memstream(const ro_memblk& blk);
+		explicit memstream(const ro_memfile& file);
+		explicit memstream(const compressed_memblk& blk);
+
+		/// Same as the block it wraps, which is opened first
+		template <typename T>
+		explicit memstream(const lazy_block<T>& blk)
+			: memstream()
+		{
+			this->open(*blk);
+		}
+
+		virtual ~memstream();
+
+		void open(const void* addr_init, uint64_t size_init);
+		void open(const ro_memblk& blk);
+		void open(const ro_memfile& file);
+		void open(const compressed_memblk& blk);
+
+		template <typename T>
+		void open(const lazy_block<T>& blk)
+		{
+			this->open(*blk);
+		}
+
+		virtual sf::Int64 read(void* dest, sf::Int64 size) override;
+		virtual sf::Int64 seek(sf::Int64 pos) override;
+		virtual sf::Int64 tell() override;
+		virtual sf::Int64 getSize() override;
+
+	};
+
+} // namespace res
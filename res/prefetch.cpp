@@ -0,0 +1,131 @@
+#include "prefetch.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "config.hpp"
+
+#if defined(PLATFORM_WIN32)
+	#include "include/win32.hpp"
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace { // anonymous
+
+	uintptr_t page_size()
+	{
+#if defined(PLATFORM_WIN32)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+#else
+		return uintptr_t(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+} // namespace anonymous
+
+namespace res {
+
+	// class prefetch {{{
+
+	prefetch::prefetch()
+		: ranges(), compressed(), held(), background(), stopping(false), finished(false)
+		, stats{0, 0, {}}
+	{
+	}
+
+	prefetch::~prefetch()
+	{
+		stopping = true;
+		if(background.joinable()) {
+			background.join();
+		}
+	}
+
+	void prefetch::run()
+	{
+		auto start = std::chrono::steady_clock::now();
+		const uintptr_t page = page_size();
+
+		// the reads must not be optimised out
+		volatile uint8_t sink = 0;
+
+		for(auto& r : ranges) {
+			auto first = reinterpret_cast<uintptr_t>(r.addr) & ~(page - 1);
+			auto last = reinterpret_cast<uintptr_t>(r.addr) + r.size;
+
+#if !defined(PLATFORM_WIN32)
+			// a hint, so failure does not matter
+			madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+#endif
+
+			// the first page may start before the range
+			auto ptr = std::max(first, reinterpret_cast<uintptr_t>(r.addr));
+			for(; ptr < last && !stopping; ptr = (ptr & ~(page - 1)) + page) {
+				sink = sink + *reinterpret_cast<const uint8_t*>(ptr);
+			}
+
+			++stats.ranges;
+			stats.bytes += r.size;
+		}
+
+		for(auto blk : compressed) {
+			if(stopping) {
+				break;
+			}
+			// a bad block throws when used, there is nothing to do here
+			try {
+				held.push_back(blk->get());
+				++stats.ranges;
+				stats.bytes += blk->size();
+			} catch(const std::exception&) {
+			}
+		}
+
+		stats.elapsed = std::chrono::steady_clock::now() - start;
+		finished = true;
+	}
+
+	void prefetch::add(const void* addr, uint64_t size)
+	{
+		assert(!background.joinable() && "manifest changed after start");
+		if(size > 0) {
+			ranges.push_back(range{addr, size});
+		}
+	}
+
+	void prefetch::add(const compressed_memblk& blk)
+	{
+		assert(!background.joinable() && "manifest changed after start");
+		compressed.push_back(&blk);
+	}
+
+	void prefetch::start()
+	{
+		assert(!background.joinable() && "prefetch already started");
+		background = std::thread([this] { this->run(); });
+	}
+
+	void prefetch::wait()
+	{
+		if(background.joinable()) {
+			background.join();
+		}
+	}
+
+	bool prefetch::done() const
+	{
+		return finished;
+	}
+
+	prefetch::statistics prefetch::get_stats() const
+	{
+		return stats;
+	}
+
+	// }}}
+
+} // namespace res
@@ -0,0 +1,111 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "res/compressed.hpp"
+#include "res/lazylib.hpp"
+
+namespace res {
+
+	/**
+	 * \class prefetch
+	 * \brief Background warmup of mapped resources
+	 *
+	 * Memory-mapped resources (ro_memfile, and ro_memblk in a resource
+	 * library) are only read from disk when each page is first touched,
+	 * which can cause hitches in the first frames. This takes a manifest
+	 * of the resources needed early on, and faults them in on a background
+	 * thread, so the main thread can create the window in the meantime.
+	 *
+	 * Ranges are advised with madvise(MADV_WILLNEED) where available, so
+	 * the kernel can read ahead, and then each page is touched. Compressed
+	 * blocks are decompressed into the decompress_cache, and held until the
+	 * prefetch is destroyed so they are not evicted before use.
+	 *
+	 * The manifest should be set up and start() called as early as
+	 * possible, e.g. at the top of initial(). The resources must stay
+	 * mapped until the prefetch is complete or destroyed.
+	 */
+	class prefetch
+	{
+	public: // statics
+
+		struct statistics
+		{
+			size_t ranges;
+			uint64_t bytes;
+			std::chrono::steady_clock::duration elapsed;
+		};
+
+	private: // statics
+
+		struct range
+		{
+			const void* addr;
+			uint64_t size;
+		};
+
+	private: // variables
+
+		std::vector<range> ranges;
+		std::vector<const compressed_memblk*> compressed;
+		std::vector<decompress_cache::block_ptr> held;
+
+		std::thread background;
+		std::atomic<bool> stopping;
+		std::atomic<bool> finished;
+
+		// only written by the background thread before finished is set
+		statistics stats;
+
+	private: // internal methods
+
+		void run();
+
+	public: // methods
+
+		prefetch();
+
+		prefetch(const prefetch&) = delete;
+		prefetch& operator=(const prefetch&) = delete;
+
+		/// Stops the prefetch if it is still running
+		~prefetch();
+
+		/// Add a range to the manifest, before start()
+		void add(const void* addr, uint64_t size);
+		void add(const compressed_memblk& blk);
+
+		/// Add a resource with get() and size(), e.g. ro_memfile
+		template <typename T>
+		void add(const T& res)
+		{
+			this->add(res.get(), res.size());
+		}
+
+		/// Add the block it wraps, which loads the library now
+		template <typename T>
+		void add(const lazy_block<T>& blk)
+		{
+			this->add(*blk);
+		}
+
+		/// Start warming up the manifest in the background
+		void start();
+
+		/// Block until the prefetch is complete
+		void wait();
+
+		bool done() const;
+
+		/// Totals of the prefetch, only valid once done()
+		statistics get_stats() const;
+
+	};
+
+} // namespace res
@@ -0,0 +1,263 @@
+#include "watcher.hpp"
+
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+
+#include <sys/stat.h>
+
+#if defined(PLATFORM_LINUX)
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace { // anonymous
+
+	// how often the background thread checks for changes, or to stop
+	constexpr auto check_interval = std::chrono::milliseconds(100);
+
+	// absolute path with links resolved, or the path as given if it doesn't exist
+	std::string canonical_dir(const std::string& dir)
+	{
+#if defined(PLATFORM_WIN32)
+		char buf[_MAX_PATH];
+		if(!_fullpath(buf, dir.c_str(), sizeof(buf))) {
+			return dir;
+		}
+		return buf;
+#else
+		std::unique_ptr<char, decltype(&std::free)> resolved(realpath(dir.c_str(), nullptr), &std::free);
+		return resolved ? std::string(resolved.get()) : dir;
+#endif
+	}
+
+} // namespace anonymous
+
+namespace res {
+
+	// class hot_memfile {{{
+
+	hot_memfile::hot_memfile(const char* filename)
+		: path(filename), file(new ro_memfile(filename)), ver(0), on_reload()
+	{
+	}
+
+	bool hot_memfile::reload(std::error_code& ec)
+	{
+		std::unique_ptr<ro_memfile> fresh(new ro_memfile());
+		if(!fresh->open(path.c_str(), ec)) {
+			return false;
+		}
+		file = std::move(fresh);
+		++ver;
+		return true;
+	}
+
+	const std::string& hot_memfile::filename() const
+	{
+		return path;
+	}
+
+	unsigned long long hot_memfile::version() const
+	{
+		return ver;
+	}
+
+	bool hot_memfile::is_open() const
+	{
+		return file->is_open();
+	}
+
+	const void* hot_memfile::get() const
+	{
+		return file->get();
+	}
+
+	uint64_t hot_memfile::size() const
+	{
+		return file->size();
+	}
+
+	// }}}
+
+	// class file_watcher {{{
+
+	file_watcher::file_key file_watcher::split_path(const std::string& path)
+	{
+		auto sep = path.find_last_of("\\/");
+		if(sep == std::string::npos) {
+			return {canonical_dir("."), path};
+		}
+		return {canonical_dir(sep == 0 ? path.substr(0, 1) : path.substr(0, sep)), path.substr(sep + 1)};
+	}
+
+#if defined(PLATFORM_LINUX)
+
+	file_watcher::file_watcher()
+		: lock(), watched(), changed(), stopping(false), background()
+		, notify_fd(-1), dir_watches()
+	{
+		notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(notify_fd == -1) {
+			throw std::system_error(errno, std::system_category());
+		}
+		background = std::thread([this] { this->watch_loop(); });
+	}
+
+	file_watcher::~file_watcher()
+	{
+		stopping = true;
+		background.join();
+		close(notify_fd);
+	}
+
+	void file_watcher::watch_loop()
+	{
+		// large enough for a few events with long names
+		alignas(inotify_event) char buf[4096];
+
+		while(!stopping) {
+			pollfd pfd{notify_fd, POLLIN, 0};
+			auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(check_interval);
+			if(::poll(&pfd, 1, int(timeout.count())) <= 0) {
+				continue;
+			}
+
+			auto len = read(notify_fd, buf, sizeof(buf));
+			if(len <= 0) {
+				continue;
+			}
+
+			std::lock_guard<std::mutex> guard(lock);
+			for(char* ptr = buf; ptr < buf + len; ) {
+				auto event = reinterpret_cast<const inotify_event*>(ptr);
+				ptr += sizeof(inotify_event) + event->len;
+
+				auto dir = dir_watches.find(event->wd);
+				if(event->len == 0 || dir == dir_watches.end()) {
+					continue;
+				}
+
+				file_key key{dir->second, event->name};
+				if(watched.count(key)) {
+					changed.insert(std::move(key));
+				}
+			}
+		}
+	}
+
+	void file_watcher::watch(hot_memfile& file)
+	{
+		auto key = split_path(file.filename());
+
+		std::lock_guard<std::mutex> guard(lock);
+		// editors often write a new file and rename it over the old
+		int wd = inotify_add_watch(notify_fd, key.first.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if(wd == -1) {
+			throw std::system_error(errno, std::system_category());
+		}
+		dir_watches[wd] = key.first;
+		watched.emplace(std::move(key), &file);
+	}
+
+#else
+
+	file_watcher::file_watcher()
+		: lock(), watched(), changed(), stopping(false), background(), mtimes()
+	{
+		background = std::thread([this] { this->watch_loop(); });
+	}
+
+	file_watcher::~file_watcher()
+	{
+		stopping = true;
+		background.join();
+	}
+
+	void file_watcher::watch_loop()
+	{
+		while(!stopping) {
+			std::this_thread::sleep_for(check_interval);
+
+			std::lock_guard<std::mutex> guard(lock);
+			for(auto& entry : mtimes) {
+				struct stat st;
+				auto fname = entry.first.first + "/" + entry.first.second;
+				if(stat(fname.c_str(), &st) != 0) {
+					// possibly in the middle of being replaced
+					continue;
+				}
+				if(st.st_mtime != entry.second) {
+					entry.second = st.st_mtime;
+					changed.insert(entry.first);
+				}
+			}
+		}
+	}
+
+	void file_watcher::watch(hot_memfile& file)
+	{
+		auto key = split_path(file.filename());
+
+		struct stat st;
+		auto fname = key.first + "/" + key.second;
+		if(stat(fname.c_str(), &st) != 0) {
+			throw std::system_error(errno, std::system_category());
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		mtimes[key] = st.st_mtime;
+		watched.emplace(std::move(key), &file);
+	}
+
+#endif
+
+	void file_watcher::unwatch(hot_memfile& file)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		for(auto it = watched.begin(); it != watched.end(); ) {
+			if(it->second != &file) {
+				++it;
+				continue;
+			}
+
+#if !defined(PLATFORM_LINUX)
+			// stop polling the file, unless another hot_memfile maps it
+			if(watched.count(it->first) == 1) {
+				mtimes.erase(it->first);
+			}
+#endif
+			it = watched.erase(it);
+		}
+		// directory watches are kept, events for unwatched files are ignored
+	}
+
+	size_t file_watcher::poll()
+	{
+		std::vector<hot_memfile*> todo;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for(auto& key : changed) {
+				auto range = watched.equal_range(key);
+				for(auto it = range.first; it != range.second; ++it) {
+					todo.push_back(it->second);
+				}
+			}
+			changed.clear();
+		}
+
+		size_t reloaded = 0;
+		for(auto file : todo) {
+			std::error_code ec;
+			if(file->reload(ec)) {
+				++reloaded;
+				file->on_reload();
+			}
+		}
+		return reloaded;
+	}
+
+	// }}}
+
+} // namespace res
@@ -0,0 +1,142 @@
+/* -*- cpp.doxygen -*- */
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "include/sigslots.hpp"
+#include "res/memfile.hpp"
+
+/**
+ * \file
+ * \brief Hot-reloadable files
+ *
+ * This provides res::hot_memfile, a memory-mapped file which can be remapped
+ * when it changes on disk, and res::file_watcher, which detects the changes.
+ * This allows assets to be edited without restarting the program.
+ */
+
+namespace res {
+
+	/**
+	 * \class hot_memfile
+	 * \brief Memory-mapped file that can be reloaded
+	 *
+	 * This is a stand-in for ro_memfile. Each reload remaps the file and
+	 * increments version(), so the address from get() may change. Objects
+	 * built from the contents (e.g. textures) can be rebuilt by connecting
+	 * to #on_reload, or by comparing the version.
+	 */
+	class hot_memfile
+	{
+	private: // variables
+
+		std::string path;
+		std::unique_ptr<ro_memfile> file;
+		unsigned long long ver;
+
+	public: // variables
+
+		/// Called after a successful reload
+		signal<> on_reload;
+
+	public: // methods
+
+		// throws std::system_error if the file cannot be opened
+		hot_memfile(const char* filename);
+
+		hot_memfile(const hot_memfile&) = delete;
+		hot_memfile& operator=(const hot_memfile&) = delete;
+
+		/// Remap the file, keeping the old mapping if this fails
+		bool reload(std::error_code& ec);
+
+		const std::string& filename() const;
+		unsigned long long version() const;
+
+		bool is_open() const;
+
+		const void* get() const;
+		uint64_t size() const;
+
+	};
+
+	/**
+	 * \class file_watcher
+	 * \brief Background watcher for hot_memfile
+	 *
+	 * A background thread watches the directories of the registered files
+	 * (with inotify on Linux, and by polling modification times elsewhere).
+	 * The files themselves are only reloaded in poll(), which should be
+	 * called from the main loop, so that no mapping is replaced while it is
+	 * being read.
+	 *
+	 * \warning
+	 * Files should not be read from other threads (e.g. res::loader) while
+	 * poll() is running.
+	 */
+	class file_watcher
+	{
+	private: // internal statics
+
+		// canonical directory and file name, so each file has one key
+		// however its directory is spelled (e.g. "./store" and "store")
+		using file_key = std::pair<std::string, std::string>;
+
+		static file_key split_path(const std::string& path);
+
+	private: // variables
+
+		std::mutex lock;
+		std::multimap<file_key, hot_memfile*> watched;
+		std::set<file_key> changed;
+
+		std::atomic<bool> stopping;
+		std::thread background;
+
+#if defined(PLATFORM_LINUX)
+		int notify_fd;
+		std::map<int, std::string> dir_watches; // watch descriptor to directory
+#else
+		std::map<file_key, long long> mtimes;
+#endif
+
+	private: // internal methods
+
+		void watch_loop();
+
+	public: // methods
+
+		file_watcher();
+
+		file_watcher(const file_watcher&) = delete;
+		file_watcher& operator=(const file_watcher&) = delete;
+
+		~file_watcher();
+
+		/// Start watching a file. It must outlive the watcher, or be unwatched
+		void watch(hot_memfile& file);
+		void unwatch(hot_memfile& file);
+
+		/**
+		 * \fn poll
+		 * \brief Reload changed files
+		 *
+		 * This remaps each changed file and triggers its
+		 * hot_memfile::on_reload. Files which fail to reload (e.g. as
+		 * they are still being written) are retried on the next
+		 * change. Returns the number of files reloaded.
+		 */
+		size_t poll();
+
+	};
+
+} // namespace res